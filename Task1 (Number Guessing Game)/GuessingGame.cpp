@@ -1,8 +1,32 @@
 #include <iostream>
+#include <iomanip>
 #include <random>
 #include <limits>
 #include <cmath>
 #include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <ctime>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 // Holds settings for a game difficulty level
@@ -13,21 +37,124 @@ struct Difficulty {
     int maxGuesses;
 };
 
-// Manages random number generation, keeping it separate from game logic
+// Where finished games are recorded between sessions
+const char* const STATS_FILE = "guessing_stats.dat";
+
+// Every difficulty level on offer, in the same order as the menu
+const Difficulty LEVELS[] = {
+    {"Easy", 1, 20, 7},
+    {"Medium", 1, 50, 6},
+    {"Hard", 1, 100, 5},
+    {"Expert", 1, 150, 10},
+};
+const int LEVEL_COUNT = sizeof(LEVELS) / sizeof(LEVELS[0]);
+
+// How far off a guess was, matching the hints the game prints
+enum class Hint { SuperClose, Hot, Warm, Far };
+
+// Everything the game tells the player about a single guess
+struct GuessFeedback {
+    int direction; // -1 if the guess was too low, 1 if too high, 0 if correct
+    Hint hint;     // Only meaningful when the guess was wrong
+};
+
+// Compares a guess with the target, without printing anything
+GuessFeedback judgeGuess(int target, int guess) {
+    GuessFeedback feedback;
+    feedback.direction = (guess < target) ? -1 : (guess > target ? 1 : 0);
+    int difference = abs(guess - target);
+    if (difference <= 5) {
+        feedback.hint = Hint::SuperClose;
+    } else if (difference <= 10) {
+        feedback.hint = Hint::Hot;
+    } else if (difference <= 20) {
+        feedback.hint = Hint::Warm;
+    } else {
+        feedback.hint = Hint::Far;
+    }
+    return feedback;
+}
+
+// Manages random number generation, keeping it separate from game logic.
+// Uses xoshiro256** (32 bytes of state instead of mt19937's 5 KB) and
+// Lemire's multiply-shift method for unbiased numbers in a range, so no
+// distribution object has to be built for each pick.
 class NumberPicker {
 private:
-    mt19937 engine; // Mersenne Twister for solid randomness
+    uint64_t state[4];
+
+    static uint64_t rotateLeft(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Produces the next raw 64 random bits
+    uint64_t next() {
+        uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+
+    // Returns a number in [0, range) without modulo bias; range is at most 2^32
+    uint32_t bounded(uint64_t range) {
+        if (range > numeric_limits<uint32_t>::max())
+            return static_cast<uint32_t>(next() >> 32);
+
+        uint64_t product = (next() >> 32) * range;
+        uint32_t leftover = static_cast<uint32_t>(product);
+        if (leftover < range) {
+            // Only a handful of values per 2^32 are rejected, so this is rare
+            uint32_t threshold = static_cast<uint32_t>((0x100000000ULL - range) % range);
+            while (leftover < threshold) {
+                product = (next() >> 32) * range;
+                leftover = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    static uint64_t spanOf(int min, int max) {
+        return static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+    }
 
 public:
     NumberPicker() {
         // Seed with random_device for unpredictable results
-        engine = mt19937(random_device()());
+        random_device device;
+        seed((static_cast<uint64_t>(device()) << 32) ^ device());
+    }
+
+    // Fixed seed, so a replay gets exactly the same numbers again
+    explicit NumberPicker(uint64_t seedValue) {
+        seed(seedValue);
+    }
+
+    // Restarts the sequence; every state word comes from SplitMix64 so that
+    // even small neighbouring seeds give unrelated streams
+    void seed(uint64_t seedValue) {
+        for (uint64_t& word : state) {
+            uint64_t z = (seedValue += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            word = z ^ (z >> 31);
+        }
     }
 
     // Picks a random number between min and max (inclusive)
     int pick(int min, int max) {
-        uniform_int_distribution<int> dist(min, max);
-        return dist(engine);
+        return static_cast<int>(min + static_cast<int64_t>(bounded(spanOf(min, max))));
+    }
+
+    // Fills out[0..count) with random numbers between min and max (inclusive)
+    void pickBatch(int min, int max, int* out, size_t count) {
+        uint64_t range = spanOf(min, max);
+        for (size_t i = 0; i < count; i++)
+            out[i] = static_cast<int>(min + static_cast<int64_t>(bounded(range)));
     }
 };
 
@@ -39,7 +166,7 @@ protected:
     NumberPicker& picker; // Use composition for random numbers
 
 public:
-    BaseGame(NumberPicker& picker) : picker(picker), guessesMade(0) {}
+    BaseGame(NumberPicker& picker) : guessesMade(0), picker(picker) {}
     virtual ~BaseGame() = default; // Virtual destructor for safe inheritance
 
     // Pure virtual methods to enforce implementation in derived classes
@@ -47,6 +174,119 @@ public:
     virtual bool runGame() = 0;
 };
 
+// A computer player that decides what to guess next.
+// Strategies only see the same feedback a human gets, never the target.
+class GuessStrategy {
+public:
+    virtual ~GuessStrategy() = default;
+
+    // Gets ready for a fresh round at the given difficulty
+    virtual void reset(const Difficulty& level) = 0;
+    // Returns the next number to guess
+    virtual int nextGuess() = 0;
+    // Learns from the feedback on a wrong guess
+    virtual void observe(int guess, const GuessFeedback& feedback) = 0;
+    // Makes an independent copy, so every simulation worker has its own state
+    virtual unique_ptr<GuessStrategy> clone() const = 0;
+    // Restarts any randomness the strategy uses, for reproducible runs
+    virtual void reseed(uint64_t) {}
+    virtual string getName() const = 0;
+};
+
+// Narrows the range using only "too low" / "too high" and guesses the middle
+class BisectionStrategy : public GuessStrategy {
+protected:
+    int low = 0;
+    int high = 0;
+
+public:
+    void reset(const Difficulty& level) override {
+        low = level.minNumber;
+        high = level.maxNumber;
+    }
+
+    int nextGuess() override {
+        return low + (high - low) / 2;
+    }
+
+    void observe(int guess, const GuessFeedback& feedback) override {
+        if (feedback.direction < 0) {
+            low = guess + 1;
+        } else {
+            high = guess - 1;
+        }
+    }
+
+    unique_ptr<GuessStrategy> clone() const override {
+        return make_unique<BisectionStrategy>(*this);
+    }
+
+    string getName() const override {
+        return "Bisection";
+    }
+};
+
+// Guesses a random number that is still possible given "too low" / "too high"
+class RandomStrategy : public BisectionStrategy {
+private:
+    NumberPicker picker; // Private generator so workers never share one
+
+public:
+    int nextGuess() override {
+        return picker.pick(low, high);
+    }
+
+    void reseed(uint64_t seedValue) override {
+        picker.seed(seedValue);
+    }
+
+    unique_ptr<GuessStrategy> clone() const override {
+        return make_unique<RandomStrategy>();
+    }
+
+    string getName() const override {
+        return "Random";
+    }
+};
+
+// Also uses the distance hints: each hint is a band around the guess, so
+// together with the direction the possible numbers always stay one range.
+class HintAwareStrategy : public BisectionStrategy {
+public:
+    void observe(int guess, const GuessFeedback& feedback) override {
+        // Distance band (inclusive) that each hint stands for
+        int nearest = 1, farthest = 5;
+        switch (feedback.hint) {
+            case Hint::SuperClose: nearest = 1;  farthest = 5; break;
+            case Hint::Hot:        nearest = 6;  farthest = 10; break;
+            case Hint::Warm:       nearest = 11; farthest = 20; break;
+            case Hint::Far:        nearest = 21; farthest = numeric_limits<int>::max() / 2; break;
+        }
+
+        if (feedback.direction < 0) {
+            low = max(low, guess + nearest);
+            high = min(high, guess + farthest);
+        } else {
+            low = max(low, guess - farthest);
+            high = min(high, guess - nearest);
+        }
+    }
+
+    unique_ptr<GuessStrategy> clone() const override {
+        return make_unique<HintAwareStrategy>(*this);
+    }
+
+    string getName() const override {
+        return "Hint-aware";
+    }
+};
+
+// How a single game ended
+struct GameOutcome {
+    bool won;
+    int guessesUsed;
+};
+
 // Implements the number guessing game
 class NumberGuesser : public BaseGame {
 private:
@@ -65,21 +305,48 @@ private:
 
     // Gives the player a hint based on how close their guess is
     virtual void provideHint(int guess) const {
-        int difference = abs(guess - targetNumber);
-        if (difference <= 5) {
-            cout << "You're super close!" << endl;
-        } else if (difference <= 10) {
-            cout << "Getting hot!" << endl;
-        } else if (difference <= 20) {
-            cout << "Warming up!" << endl;
-        } else {
-            cout << "Pretty far off!" << endl;
+        switch (judgeGuess(targetNumber, guess).hint) {
+            case Hint::SuperClose:
+                cout << "You're super close!" << endl;
+                break;
+            case Hint::Hot:
+                cout << "Getting hot!" << endl;
+                break;
+            case Hint::Warm:
+                cout << "Warming up!" << endl;
+                break;
+            case Hint::Far:
+                cout << "Pretty far off!" << endl;
+                break;
         }
     }
 
+    // Starts a new round at the given level with a fresh target
+    void startRound(const Difficulty& level) {
+        settings = level;
+        setTarget();
+        guessesMade = 0;
+    }
+
+    // Starts a new round with a target chosen by the caller
+    void startRound(const Difficulty& level, int target) {
+        settings = level;
+        targetNumber = target;
+        guessesMade = 0;
+    }
+
+    // Counts a valid guess and reports how it compares to the target
+    GuessFeedback submitGuess(int guess) {
+        guessesMade++;
+        return judgeGuess(targetNumber, guess);
+    }
+
 public:
     NumberGuesser(NumberPicker& picker) : BaseGame(picker) {}
 
+    const Difficulty& getSettings() const { return settings; }
+    int getGuessesMade() const { return guessesMade; }
+
     // Lets the player pick a difficulty level
     void setupDifficulty() override {
         int choice;
@@ -92,27 +359,13 @@ public:
         cin >> choice;
 
         // Set up the difficulty based on player choice
-        switch (choice) {
-            case 1:
-                settings = {"Easy", 1, 20, 7};
-                break;
-            case 2:
-                settings = {"Medium", 1, 50, 6};
-                break;
-            case 3:
-                settings = {"Hard", 1, 100, 5};
-                break;
-            case 4:
-                settings = {"Expert", 1, 150, 10};
-                break;
-            default:
-                cout << "That’s not a valid choice. Let’s go with Easy.\n";
-                settings = {"Easy", 1, 20, 7};
+        if (choice < 1 || choice > LEVEL_COUNT) {
+            cout << "That’s not a valid choice. Let’s go with Easy.\n";
+            choice = 1;
         }
 
         // Generate the target number and reset guesses
-        setTarget();
-        guessesMade = 0;
+        startRound(LEVELS[choice - 1]);
 
         cout << "\nYou’re playing " << settings.levelName << " mode!\n";
         cout << "I’ve picked a number between " << settings.minNumber << " and " << settings.maxNumber << ".\n";
@@ -142,14 +395,14 @@ public:
                 continue;
             }
 
-            guessesMade++;
+            GuessFeedback feedback = submitGuess(guess);
 
             // Check if the guess is correct
-            if (guess == targetNumber) {
+            if (feedback.direction == 0) {
                 cout << "\nNailed it! You got it in " << guessesMade << " guess(es)!\n" << endl;
                 return true;
             } else {
-                if (guess < targetNumber) {
+                if (feedback.direction < 0) {
                     cout << "Too low!" << endl;
                 } else {
                     cout << "Too high!" << endl;
@@ -164,18 +417,899 @@ public:
         cout << "Out of guesses! The number was " << targetNumber << ".\n" << endl;
         return false;
     }
+
+    // Plays one whole round with a computer strategy, without any console I/O
+    GameOutcome playHeadless(const Difficulty& level, GuessStrategy& strategy) {
+        startRound(level);
+        return finishHeadless(strategy);
+    }
+
+    // Same, but against a target the caller already picked (e.g. in bulk)
+    GameOutcome playHeadless(const Difficulty& level, GuessStrategy& strategy, int target) {
+        startRound(level, target);
+        return finishHeadless(strategy);
+    }
+
+private:
+    // Lets the strategy guess until the round is won or out of guesses
+    GameOutcome finishHeadless(GuessStrategy& strategy) {
+        strategy.reset(settings);
+
+        while (guessesMade < settings.maxGuesses) {
+            int guess = strategy.nextGuess();
+            if (!isGuessValid(guess)) {
+                // A strategy that runs out of candidates has been fooling itself
+                guess = min(max(guess, settings.minNumber), settings.maxNumber);
+            }
+
+            GuessFeedback feedback = submitGuess(guess);
+            if (feedback.direction == 0) {
+                return {true, guessesMade};
+            }
+            strategy.observe(guess, feedback);
+        }
+        return {false, guessesMade};
+    }
+};
+
+// Results for one difficulty level, gathered over many simulated games
+struct LevelStats {
+    long long games = 0;
+    long long wins = 0;
+    // winsByGuesses[n] = games won on exactly the n-th guess
+    vector<long long> winsByGuesses;
+
+    void merge(const LevelStats& other) {
+        games += other.games;
+        wins += other.wins;
+        if (winsByGuesses.size() < other.winsByGuesses.size())
+            winsByGuesses.resize(other.winsByGuesses.size(), 0);
+        for (size_t i = 0; i < other.winsByGuesses.size(); i++)
+            winsByGuesses[i] += other.winsByGuesses[i];
+    }
+};
+
+// Plays huge numbers of headless games on every core to check how
+// winnable each difficulty level is for a given strategy
+class Simulator {
+private:
+    int threadCount;
+    uint64_t baseSeed;
+
+    // Targets are drawn this many at a time so picking stays out of the game loop
+    static const size_t TARGET_BATCH = 4096;
+
+    // One worker's share of the games; everything it touches is its own
+    static void runWorker(const GuessStrategy& prototype, long long gamesPerLevel,
+                          uint64_t seed, vector<LevelStats>& results) {
+        NumberPicker picker(seed); // Each worker gets its own generator
+        NumberGuesser game(picker);
+        unique_ptr<GuessStrategy> strategy = prototype.clone();
+        strategy->reseed(seed ^ 0x5DEECE66DULL);
+        vector<int> targets(TARGET_BATCH);
+
+        for (int level = 0; level < LEVEL_COUNT; level++) {
+            const Difficulty& difficulty = LEVELS[level];
+            LevelStats& stats = results[level];
+            stats.winsByGuesses.assign(difficulty.maxGuesses + 1, 0);
+
+            for (long long done = 0; done < gamesPerLevel; ) {
+                size_t batch = static_cast<size_t>(min<long long>(TARGET_BATCH, gamesPerLevel - done));
+                picker.pickBatch(difficulty.minNumber, difficulty.maxNumber, targets.data(), batch);
+                for (size_t i = 0; i < batch; i++) {
+                    GameOutcome outcome = game.playHeadless(difficulty, *strategy, targets[i]);
+                    stats.games++;
+                    if (outcome.won) {
+                        stats.wins++;
+                        stats.winsByGuesses[outcome.guessesUsed]++;
+                    }
+                }
+                done += batch;
+            }
+        }
+    }
+
+    // Prints win rate and the guess-count histogram for every level
+    static void printReport(const string& strategyName, const vector<LevelStats>& totals) {
+        cout << "\nStrategy: " << strategyName << "\n";
+        for (int level = 0; level < LEVEL_COUNT; level++) {
+            const LevelStats& stats = totals[level];
+            double winRate = stats.games ? 100.0 * stats.wins / stats.games : 0.0;
+            double totalGuesses = 0;
+            for (size_t n = 1; n < stats.winsByGuesses.size(); n++)
+                totalGuesses += double(n) * stats.winsByGuesses[n];
+
+            cout << "  " << left << setw(7) << LEVELS[level].levelName << right
+                 << " win rate " << fixed << setprecision(2) << setw(6) << winRate << "%"
+                 << ", mean guesses to win "
+                 << (stats.wins ? totalGuesses / stats.wins : 0.0) << "\n";
+
+            for (size_t n = 1; n < stats.winsByGuesses.size(); n++) {
+                double share = stats.games ? 100.0 * stats.winsByGuesses[n] / stats.games : 0.0;
+                cout << "    " << setw(2) << n << " guess(es): " << setw(6) << share << "% "
+                     << string(static_cast<size_t>(share / 2), '#') << "\n";
+            }
+            double lost = stats.games ? 100.0 * (stats.games - stats.wins) / stats.games : 0.0;
+            cout << "    lost:        " << setw(6) << lost << "% "
+                 << string(static_cast<size_t>(lost / 2), '#') << "\n";
+        }
+        cout << resetiosflags(ios::fixed) << setprecision(6);
+    }
+
+public:
+    // The same seed and thread count always replay exactly the same games
+    Simulator(int threads, uint64_t seed) : threadCount(max(1, threads)), baseSeed(seed) {}
+
+    // Runs gamesPerLevel games on every level and prints the aggregate results
+    void run(const GuessStrategy& prototype, long long gamesPerLevel) {
+        // Per-worker results stay separate until the end, so workers never
+        // write to shared memory while they play
+        vector<vector<LevelStats>> results(threadCount, vector<LevelStats>(LEVEL_COUNT));
+        vector<thread> workers;
+
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threadCount; t++) {
+            long long share = gamesPerLevel / threadCount + (t < gamesPerLevel % threadCount ? 1 : 0);
+            workers.emplace_back(runWorker, cref(prototype), share, baseSeed + t, ref(results[t]));
+        }
+        for (thread& worker : workers)
+            worker.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        vector<LevelStats> totals(LEVEL_COUNT);
+        for (const vector<LevelStats>& perWorker : results)
+            for (int level = 0; level < LEVEL_COUNT; level++)
+                totals[level].merge(perWorker[level]);
+
+        printReport(prototype.getName(), totals);
+        double games = double(gamesPerLevel) * LEVEL_COUNT;
+        cout << "  " << static_cast<long long>(games) << " games on " << threadCount << " thread(s) in "
+             << fixed << setprecision(3) << seconds << "s ("
+             << setprecision(0) << (seconds > 0 ? games / seconds : 0.0) << " games/sec)\n"
+             << resetiosflags(ios::fixed) << setprecision(6);
+    }
+};
+
+#ifdef __linux__
+// Raises the open-file limit as far as allowed, since every player is a socket
+void raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// Fills in a Unix-domain socket address, refusing paths that do not fit
+bool makeSocketAddress(const string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cout << "Socket path is too long: " << path << "\n";
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+// Short word the server sends for each hint
+const char* hintWord(Hint hint) {
+    switch (hint) {
+        case Hint::SuperClose: return "close";
+        case Hint::Hot: return "hot";
+        case Hint::Warm: return "warm";
+        case Hint::Far: return "far";
+    }
+    return "far";
+}
+
+// Hosts many independent guessing games over a Unix-domain socket.
+// Each connection is a small state machine driven by one epoll loop, so a
+// single thread can serve thousands of players. Line protocol:
+//   NEW <level 1-4>   ->  READY <min> <max> <guesses>
+//   GUESS <number>    ->  LOW|HIGH <hint> <guesses left>, WIN <guesses> or LOSE <target>
+// Anything else gets "ERR <reason>". Requests may be pipelined: replies the
+// socket has no room for are queued, and the server stops reading from that
+// player until they have drained.
+class GameServer {
+private:
+    static const size_t MAX_REPLY = 48; // Longest reply handleRequest() writes
+
+    // Everything the server remembers about one player, kept deliberately small
+    struct GameSession {
+        int target = 0;
+        int8_t level = -1;         // Index into LEVELS, -1 until NEW is sent
+        uint8_t guessesMade = 0;
+        uint8_t inLength = 0;
+        char in[48];               // Partial request line
+        unique_ptr<string> unsent; // Replies that did not fit in the socket yet, usually none
+    };
+
+    string socketPath;
+    int listenFd = -1;
+    int epollFd = -1;
+    bool acceptPaused = false;     // Out of descriptors: the listen socket is not watched for now
+    NumberPicker picker;
+    vector<unique_ptr<GameSession>> sessions; // Indexed by file descriptor
+    long long activeSessions = 0;
+
+    // Handles one complete request line and writes the reply into out
+    int handleRequest(GameSession& session, const char* line, char* out, size_t outSize) {
+        int value = 0;
+        if (sscanf(line, "NEW %d", &value) == 1) {
+            if (value < 1 || value > LEVEL_COUNT)
+                return snprintf(out, outSize, "ERR level must be 1-%d\n", LEVEL_COUNT);
+            const Difficulty& level = LEVELS[value - 1];
+            session.level = static_cast<int8_t>(value - 1);
+            session.guessesMade = 0;
+            session.target = picker.pick(level.minNumber, level.maxNumber);
+            return snprintf(out, outSize, "READY %d %d %d\n", level.minNumber, level.maxNumber, level.maxGuesses);
+        }
+
+        if (sscanf(line, "GUESS %d", &value) == 1) {
+            if (session.level < 0)
+                return snprintf(out, outSize, "ERR send NEW first\n");
+            const Difficulty& level = LEVELS[session.level];
+            if (value < level.minNumber || value > level.maxNumber)
+                return snprintf(out, outSize, "ERR guess must be %d-%d\n", level.minNumber, level.maxNumber);
+
+            session.guessesMade++;
+            GuessFeedback feedback = judgeGuess(session.target, value);
+            if (feedback.direction == 0) {
+                session.level = -1;
+                return snprintf(out, outSize, "WIN %d\n", session.guessesMade);
+            }
+            if (session.guessesMade >= level.maxGuesses) {
+                session.level = -1;
+                return snprintf(out, outSize, "LOSE %d\n", session.target);
+            }
+            return snprintf(out, outSize, "%s %s %d\n", feedback.direction < 0 ? "LOW" : "HIGH",
+                            hintWord(feedback.hint), level.maxGuesses - session.guessesMade);
+        }
+
+        return snprintf(out, outSize, "ERR unknown command\n");
+    }
+
+    // Stops or resumes watching the listen socket. A failing accept (such
+    // as EMFILE) leaves it readable, so it would otherwise wake every loop.
+    // If it cannot be watched again, accepting stays paused and run()
+    // retries after its timeout.
+    void watchListener(bool watch) {
+        if (acceptPaused != watch)
+            return;
+        if (watch) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = listenFd;
+            acceptPaused = epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0;
+        } else {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, listenFd, nullptr);
+            acceptPaused = true;
+        }
+    }
+
+    void closeSession(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        sessions[fd].reset();
+        activeSessions--;
+        watchListener(true); // A descriptor is free again
+    }
+
+    // Sends replies, behind any already queued; what the socket has no room
+    // for is queued. False if the peer is gone.
+    bool sendReplies(int fd, GameSession& session, const char* replies, size_t length) {
+        if (session.unsent) {
+            session.unsent->append(replies, length);
+            return true;
+        }
+        ssize_t sent = send(fd, replies, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            return false;
+        size_t done = sent < 0 ? 0 : static_cast<size_t>(sent);
+        if (done < length)
+            session.unsent = make_unique<string>(replies + done, length - done);
+        return true;
+    }
+
+    // Sends as much of the queued replies as the socket takes, waiting for
+    // EPOLLOUT if some are left; false if the peer is gone
+    bool flushReply(int fd, GameSession& session) {
+        string& unsent = *session.unsent;
+        size_t done = 0;
+        while (done < unsent.size()) {
+            ssize_t sent = send(fd, unsent.data() + done, unsent.size() - done, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    unsent.erase(0, done);
+                    epoll_event event{};
+                    event.events = EPOLLOUT;
+                    event.data.fd = fd;
+                    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+                    return true;
+                }
+                return false;
+            }
+            done += static_cast<size_t>(sent);
+        }
+        session.unsent.reset();
+        return true;
+    }
+
+    // Reads what the player sent and answers every complete line, in
+    // batches of replies. Once replies are queued it stops reading, so a
+    // player who pipelines more than they read waits for their answers.
+    bool serviceRead(int fd, GameSession& session) {
+        char buffer[512];
+        char replies[2048];
+        while (true) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received == 0)
+                return false;
+            if (received < 0)
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+
+            size_t replyLength = 0;
+            for (ssize_t i = 0; i < received; i++) {
+                char c = buffer[i];
+                if (c != '\n') {
+                    if (static_cast<size_t>(session.inLength) + 1 >= sizeof(session.in))
+                        return false; // Nobody sends lines this long on purpose
+                    session.in[session.inLength++] = c;
+                    continue;
+                }
+                session.in[session.inLength] = '\0';
+                session.inLength = 0;
+                if (replyLength + MAX_REPLY > sizeof(replies)) {
+                    if (!sendReplies(fd, session, replies, replyLength))
+                        return false;
+                    replyLength = 0;
+                }
+                replyLength += handleRequest(session, session.in, replies + replyLength, MAX_REPLY);
+            }
+
+            if (replyLength > 0 && !sendReplies(fd, session, replies, replyLength))
+                return false;
+            if (session.unsent)
+                return flushReply(fd, session); // The socket is full; wait until it drains
+        }
+    }
+
+    void acceptPlayers() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                // Out of descriptors or memory: wait for a player to leave,
+                // or for the retry timeout in run()
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    watchListener(false);
+                return;
+            }
+
+            if (static_cast<size_t>(fd) >= sessions.size())
+                sessions.resize(fd + 1024);
+            sessions[fd] = make_unique<GameSession>();
+            activeSessions++;
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+                // Out of kernel memory or epoll watches: turn the player away
+                // and wait, as for a failed accept
+                close(fd);
+                sessions[fd].reset();
+                activeSessions--;
+                watchListener(false);
+                return;
+            }
+        }
+    }
+
+public:
+    GameServer(const string& path) : socketPath(path) {}
+
+    ~GameServer() {
+        for (size_t fd = 0; fd < sessions.size(); fd++)
+            if (sessions[fd])
+                close(static_cast<int>(fd));
+        if (epollFd >= 0) close(epollFd);
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+    }
+
+    // Binds the socket and serves players until the process is stopped
+    bool run() {
+        sockaddr_un address;
+        if (!makeSocketAddress(socketPath, address))
+            return false;
+        raiseFileLimit();
+        signal(SIGPIPE, SIG_IGN);
+
+        unlink(socketPath.c_str()); // Leftover from a previous run
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listenFd, SOMAXCONN) < 0) {
+            cout << "Could not listen on " << socketPath << ": " << strerror(errno) << "\n";
+            return false;
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event listenEvent{};
+        listenEvent.events = EPOLLIN;
+        listenEvent.data.fd = listenFd;
+        if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) < 0) {
+            cout << "Could not watch " << socketPath << ": " << strerror(errno) << "\n";
+            return false;
+        }
+        cout << "Serving guessing games on " << socketPath << " (Ctrl+C to stop)\n";
+
+        epoll_event events[256];
+        while (true) {
+            int ready = epoll_wait(epollFd, events, 256, acceptPaused ? 100 : -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                cout << "epoll_wait failed: " << strerror(errno) << "\n";
+                return false;
+            }
+            if (ready == 0)
+                watchListener(true); // Try accepting again
+
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptPlayers();
+                    continue;
+                }
+
+                GameSession& session = *sessions[fd];
+                bool alive = !(events[i].events & (EPOLLERR | EPOLLHUP)) || (events[i].events & EPOLLIN);
+                if (alive && (events[i].events & EPOLLOUT) && session.unsent) {
+                    alive = flushReply(fd, session);
+                    if (alive && !session.unsent) {
+                        epoll_event event{};
+                        event.events = EPOLLIN;
+                        event.data.fd = fd;
+                        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+                    }
+                }
+                if (alive && (events[i].events & EPOLLIN) && !session.unsent)
+                    alive = serviceRead(fd, session);
+                if (!alive)
+                    closeSession(fd);
+            }
+        }
+    }
+};
+
+// Drives a GameServer with many simulated players and reports how long
+// each guess took to be answered
+class LoadGenerator {
+private:
+    // One simulated player: a socket plus the strategy choosing its guesses
+    struct Player {
+        int fd = -1;
+        HintAwareStrategy strategy;
+        int level = 0;
+        int lastGuess = 0;
+        chrono::steady_clock::time_point sentAt;
+        string pending;
+    };
+
+    string socketPath;
+    int connections;
+    int threadCount;
+    double seconds;
+
+    // Sends one request line and notes the time so the reply can be timed
+    static bool sendLine(Player& player, const string& line) {
+        player.sentAt = chrono::steady_clock::now();
+        return send(player.fd, line.data(), line.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(line.size());
+    }
+
+    // Reacts to a reply from the server by asking the next question
+    static bool onReply(Player& player, const string& reply, long long& games) {
+        if (reply.compare(0, 5, "READY") == 0) {
+            player.strategy.reset(LEVELS[player.level]);
+        } else if (reply.compare(0, 3, "LOW") == 0 || reply.compare(0, 4, "HIGH") == 0) {
+            GuessFeedback feedback;
+            feedback.direction = reply[0] == 'L' ? -1 : 1;
+            char word[16] = "";
+            sscanf(reply.c_str(), "%*s %15s", word);
+            string hint = word;
+            feedback.hint = hint == "close" ? Hint::SuperClose : hint == "hot" ? Hint::Hot
+                          : hint == "warm" ? Hint::Warm : Hint::Far;
+            player.strategy.observe(player.lastGuess, feedback);
+        } else if (reply.compare(0, 3, "WIN") == 0 || reply.compare(0, 4, "LOSE") == 0) {
+            games++;
+            player.level = (player.level + 1) % LEVEL_COUNT;
+            return sendLine(player, "NEW " + to_string(player.level + 1) + "\n");
+        } else {
+            cout << "Unexpected reply: " << reply << "\n";
+            return false;
+        }
+
+        player.lastGuess = player.strategy.nextGuess();
+        return sendLine(player, "GUESS " + to_string(player.lastGuess) + "\n");
+    }
+
+    // One thread's players, all multiplexed on a private epoll instance
+    void runWorker(int playerCount, vector<float>& latencies, long long& games) {
+        sockaddr_un address;
+        makeSocketAddress(socketPath, address);
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        vector<Player> players(playerCount);
+
+        for (int i = 0; i < playerCount; i++) {
+            Player& player = players[i];
+            player.fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (player.fd < 0 || connect(player.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+                cout << "Could not connect player " << i << ": " << strerror(errno) << "\n";
+                break;
+            }
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = static_cast<uint32_t>(i);
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, player.fd, &event) < 0) {
+                cout << "Could not watch player " << i << ": " << strerror(errno) << "\n";
+                break;
+            }
+            player.level = i % LEVEL_COUNT;
+            sendLine(player, "NEW " + to_string(player.level + 1) + "\n");
+        }
+
+        auto stopAt = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+        epoll_event events[256];
+        char buffer[1024];
+        while (chrono::steady_clock::now() < stopAt) {
+            int ready = epoll_wait(epollFd, events, 256, 100);
+            for (int i = 0; i < ready; i++) {
+                Player& player = players[events[i].data.u32];
+                ssize_t received = recv(player.fd, buffer, sizeof(buffer), 0);
+                if (received <= 0) {
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, player.fd, nullptr);
+                    continue;
+                }
+                player.pending.append(buffer, received);
+                size_t newline;
+                while ((newline = player.pending.find('\n')) != string::npos) {
+                    string reply = player.pending.substr(0, newline);
+                    player.pending.erase(0, newline + 1);
+                    latencies.push_back(chrono::duration<float, micro>(chrono::steady_clock::now() - player.sentAt).count());
+                    if (!onReply(player, reply, games))
+                        epoll_ctl(epollFd, EPOLL_CTL_DEL, player.fd, nullptr);
+                }
+            }
+        }
+
+        for (Player& player : players)
+            if (player.fd >= 0)
+                close(player.fd);
+        close(epollFd);
+    }
+
+public:
+    LoadGenerator(const string& path, int connections, int threads, double seconds)
+        : socketPath(path), connections(max(1, connections)), threadCount(max(1, threads)), seconds(seconds) {}
+
+    void run() {
+        raiseFileLimit();
+        signal(SIGPIPE, SIG_IGN);
+        vector<vector<float>> latencies(threadCount);
+        vector<long long> games(threadCount, 0);
+        vector<thread> workers;
+
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threadCount; t++) {
+            int share = connections / threadCount + (t < connections % threadCount ? 1 : 0);
+            workers.emplace_back(&LoadGenerator::runWorker, this, share, ref(latencies[t]), ref(games[t]));
+        }
+        for (thread& worker : workers)
+            worker.join();
+        // Rates are over the time the workers actually ran, not the time asked for
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        vector<float> all;
+        long long totalGames = 0;
+        for (int t = 0; t < threadCount; t++) {
+            all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+            totalGames += games[t];
+        }
+        if (all.empty()) {
+            cout << "No replies received.\n";
+            return;
+        }
+
+        auto percentile = [&](double p) {
+            size_t index = min(all.size() - 1, static_cast<size_t>(p * all.size()));
+            nth_element(all.begin(), all.begin() + index, all.end());
+            return all[index];
+        };
+        cout << fixed << setprecision(1)
+             << connections << " players, " << all.size() << " requests, " << totalGames << " games in "
+             << setprecision(2) << elapsed << "s\n" << setprecision(1)
+             << "  " << all.size() / elapsed << " requests/sec, " << totalGames / elapsed << " games/sec\n"
+             << "  latency p50 " << percentile(0.50) << "us, p99 " << percentile(0.99)
+             << "us, p99.9 " << percentile(0.999) << "us\n"
+             << resetiosflags(ios::fixed) << setprecision(6);
+    }
+};
+
+// One finished game as stored on disk
+struct GameRecord {
+    int64_t timestamp;   // Seconds since the Unix epoch
+    uint8_t level;       // Index into LEVELS
+    uint8_t guessesUsed;
+    uint8_t won;
+    uint8_t reserved[5];
+};
+
+// Persistent record of every finished game plus per-level leaderboards.
+// The file is a fixed header followed by fixed-size records and is used
+// through a memory map: recording a game appends one record and updates
+// the running totals and top-N table in the header, so opening the store
+// and answering "top 10" or "mean guesses" never scans the history.
+// Several games may share the file: writers hold an exclusive flock while
+// they append, and each process remaps when another one has grown it.
+class StatsStore {
+public:
+    static const int TOP_COUNT = 10;
+    static constexpr int MAX_GUESSES = 16; // Upper bound for the histogram
+
+    // Running totals and leaderboard for one difficulty level
+    struct LevelSummary {
+        uint64_t games;
+        uint64_t wins;
+        uint64_t guessesOnWins;
+        uint64_t winsByGuesses[MAX_GUESSES + 1];
+        uint32_t topCount;
+        uint32_t reserved;
+        GameRecord top[TOP_COUNT]; // Best wins first: fewest guesses, then earliest
+    };
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t recordCount;
+        uint64_t capacity;
+        LevelSummary levels[LEVEL_COUNT];
+    };
+
+    // Records start on their own page so the header can grow in later versions
+    static const size_t HEADER_BYTES = 4096;
+    static_assert(sizeof(Header) <= HEADER_BYTES, "stats header must fit in its page");
+
+    int fd = -1;
+    char* mapping = nullptr;
+    size_t mappedBytes = 0;
+
+    Header& header() const { return *reinterpret_cast<Header*>(mapping); }
+    GameRecord* records() const { return reinterpret_cast<GameRecord*>(mapping + HEADER_BYTES); }
+
+    static size_t bytesFor(uint64_t capacity) {
+        return HEADER_BYTES + capacity * sizeof(GameRecord);
+    }
+
+    // Doubles the record area; the file grows and the map follows it
+    bool grow() {
+        uint64_t capacity = max<uint64_t>(1024, header().capacity * 2);
+        size_t bytes = bytesFor(capacity);
+        if (ftruncate(fd, static_cast<off_t>(bytes)) < 0)
+            return false;
+        void* moved = mremap(mapping, mappedBytes, bytes, MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED)
+            return false;
+        mapping = static_cast<char*>(moved);
+        mappedBytes = bytes;
+        header().capacity = capacity;
+        return true;
+    }
+
+    // Catches the map up with a file another process has grown
+    bool follow() {
+        size_t bytes = bytesFor(header().capacity);
+        if (bytes <= mappedBytes)
+            return true;
+        void* moved = mremap(mapping, mappedBytes, bytes, MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED)
+            return false;
+        mapping = static_cast<char*>(moved);
+        mappedBytes = bytes;
+        return true;
+    }
+
+    // Appends under the writer lock; see record()
+    bool append(int level, int guessesUsed, bool won, int64_t timestamp) {
+        if (!follow())
+            return false;
+        if (header().recordCount == header().capacity && !grow())
+            return false;
+
+        GameRecord entry{};
+        entry.timestamp = timestamp;
+        entry.level = static_cast<uint8_t>(level);
+        entry.guessesUsed = static_cast<uint8_t>(min(guessesUsed, MAX_GUESSES));
+        entry.won = won ? 1 : 0;
+        records()[header().recordCount] = entry;
+        header().recordCount++;
+
+        LevelSummary& summary = header().levels[level];
+        summary.games++;
+        if (won) {
+            summary.wins++;
+            summary.guessesOnWins += entry.guessesUsed;
+            summary.winsByGuesses[entry.guessesUsed]++;
+            updateTop(summary, entry);
+        }
+        return true;
+    }
+
+    // True if a should rank above b on the leaderboard
+    static bool ranksAbove(const GameRecord& a, const GameRecord& b) {
+        if (a.guessesUsed != b.guessesUsed)
+            return a.guessesUsed < b.guessesUsed;
+        return a.timestamp < b.timestamp;
+    }
+
+    // Slots a win into the fixed-size leaderboard (at most TOP_COUNT moves)
+    static void updateTop(LevelSummary& summary, const GameRecord& record) {
+        uint32_t position = summary.topCount;
+        if (position == TOP_COUNT) {
+            if (!ranksAbove(record, summary.top[TOP_COUNT - 1]))
+                return;
+            position--;
+        } else {
+            summary.topCount++;
+        }
+        while (position > 0 && ranksAbove(record, summary.top[position - 1])) {
+            summary.top[position] = summary.top[position - 1];
+            position--;
+        }
+        summary.top[position] = record;
+    }
+
+public:
+    StatsStore() = default;
+    StatsStore(const StatsStore&) = delete;
+    StatsStore& operator=(const StatsStore&) = delete;
+
+    ~StatsStore() {
+        close();
+    }
+
+    // Opens the store, creating it if needed; false if the file is unusable
+    bool open(const string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+
+        // Held until the header is checked so two first openers don't both format it
+        if (flock(fd, LOCK_EX) < 0) {
+            close();
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) < 0) {
+            close();
+            return false;
+        }
+        bool fresh = info.st_size == 0;
+        size_t bytes = fresh ? bytesFor(1024) : static_cast<size_t>(info.st_size);
+        if ((fresh && ftruncate(fd, static_cast<off_t>(bytes)) < 0) || bytes < HEADER_BYTES) {
+            close();
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close();
+            return false;
+        }
+        mapping = static_cast<char*>(mapped);
+        mappedBytes = bytes;
+
+        Header& head = header();
+        if (fresh) {
+            memcpy(head.magic, "GGSTATS1", 8);
+            head.version = 1;
+            head.recordSize = sizeof(GameRecord);
+            head.capacity = 1024;
+        } else if (memcmp(head.magic, "GGSTATS1", 8) != 0 || head.recordSize != sizeof(GameRecord) ||
+                   bytesFor(head.capacity) > mappedBytes || head.recordCount > head.capacity) {
+            close();
+            return false;
+        }
+        flock(fd, LOCK_UN);
+        return true;
+    }
+
+    void close() {
+        if (mapping) munmap(mapping, mappedBytes);
+        if (fd >= 0) ::close(fd);
+        mapping = nullptr;
+        mappedBytes = 0;
+        fd = -1;
+    }
+
+    bool isOpen() const { return mapping != nullptr; }
+
+    // Appends one finished game and folds it into the totals, in O(1)
+    bool record(int level, int guessesUsed, bool won, int64_t timestamp) {
+        if (!isOpen() || level < 0 || level >= LEVEL_COUNT)
+            return false;
+        if (flock(fd, LOCK_EX) < 0)
+            return false;
+        bool appended = append(level, guessesUsed, won, timestamp);
+        flock(fd, LOCK_UN);
+        return appended;
+    }
+
+    uint64_t gameCount() const { return isOpen() ? header().recordCount : 0; }
+
+    const LevelSummary& summary(int level) const { return header().levels[level]; }
+
+    // Random access into the history, e.g. for replays or exports
+    const GameRecord& game(uint64_t index) const { return records()[index]; }
+
+    // Prints the leaderboard and averages for every level
+    void printReport() const {
+        flock(fd, LOCK_SH); // The header lives in the first page, which is always mapped
+        cout << gameCount() << " game(s) recorded\n";
+        for (int level = 0; level < LEVEL_COUNT; level++) {
+            const LevelSummary& s = summary(level);
+            cout << "\n" << LEVELS[level].levelName << ": " << s.games << " played, " << s.wins << " won";
+            if (s.wins)
+                cout << ", " << fixed << setprecision(2) << double(s.guessesOnWins) / s.wins
+                     << " guesses per win" << resetiosflags(ios::fixed) << setprecision(6);
+            cout << "\n";
+            for (uint32_t i = 0; i < s.topCount; i++) {
+                time_t when = static_cast<time_t>(s.top[i].timestamp);
+                char date[32];
+                strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&when));
+                cout << "  " << setw(2) << i + 1 << ". " << int(s.top[i].guessesUsed) << " guess(es)  " << date << "\n";
+            }
+        }
+        flock(fd, LOCK_UN);
+    }
 };
 
-int main() {
+// Level index for a difficulty, matched by name
+int levelIndexOf(const Difficulty& level) {
+    for (int i = 0; i < LEVEL_COUNT; i++)
+        if (LEVELS[i].levelName == level.levelName)
+            return i;
+    return -1;
+}
+#endif
+
+// Plays the interactive game until the player has had enough
+void playInteractive() {
     cout << "Welcome to the Guessing Number Challenge!\n";
 
     NumberPicker picker; // One random number generator for the whole game
     char replay;
+#ifdef __linux__
+    StatsStore stats; // Every finished game is kept for the leaderboard
+    if (!stats.open(STATS_FILE))
+        cout << "(Could not open " << STATS_FILE << ", this session will not be recorded.)\n";
+#endif
 
     do {
         NumberGuesser game(picker); // Create a new game
         game.setupDifficulty();
-        game.runGame();
+        bool won = game.runGame();
+#ifdef __linux__
+        stats.record(levelIndexOf(game.getSettings()), game.getGuessesMade(), won, time(nullptr));
+#else
+        (void)won;
+#endif
 
         cout << "Want to try again? (y/n): ";
         cin >> replay;
@@ -183,5 +1317,159 @@ int main() {
     } while (replay == 'y' || replay == 'Y');
 
     cout << "Thanks for playing! Come back anytime.\n";
-    return 0;
-}
\ No newline at end of file
+}
+
+// Compares the old per-call mt19937 + distribution picking with the batched API
+void benchmarkPicker(size_t count) {
+    const int minNumber = 1, maxNumber = 150;
+    vector<int> buffer(count);
+    long long checksum = 0;
+
+    auto timeIt = [&](const string& name, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        body();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        for (int value : buffer)
+            checksum += value;
+        cout << "  " << left << setw(34) << name << right << fixed << setprecision(2)
+             << setw(8) << seconds * 1e9 / count << " ns/number\n" << resetiosflags(ios::fixed);
+    };
+
+    cout << "Picking " << count << " numbers in [" << minNumber << ", " << maxNumber << "]\n";
+    timeIt("mt19937 + distribution per call", [&] {
+        mt19937 engine(12345);
+        for (size_t i = 0; i < count; i++) {
+            uniform_int_distribution<int> dist(minNumber, maxNumber);
+            buffer[i] = dist(engine);
+        }
+    });
+    timeIt("NumberPicker::pick", [&] {
+        NumberPicker picker(12345);
+        for (size_t i = 0; i < count; i++)
+            buffer[i] = picker.pick(minNumber, maxNumber);
+    });
+    timeIt("NumberPicker::pickBatch", [&] {
+        NumberPicker picker(12345);
+        picker.pickBatch(minNumber, maxNumber, buffer.data(), count);
+    });
+    cout << "  state size: mt19937 " << sizeof(mt19937) << " bytes, NumberPicker "
+         << sizeof(NumberPicker) << " bytes (checksum " << checksum << ")\n";
+}
+
+void printUsage(const char* program) {
+    cout << "Usage:\n"
+         << "  " << program << "                                          play interactively\n"
+         << "  " << program << " --simulate [gamesPerLevel] [threads] [seed]   run headless strategy simulations\n"
+         << "  " << program << " --bench-rng [count]                           time the random number picker\n"
+#ifdef __linux__
+         << "  " << program << " --serve [socketPath]                          host games over a Unix socket\n"
+         << "  " << program << " --loadgen [socketPath] [players] [threads] [seconds]   load-test a server\n"
+         << "  " << program << " --stats [file]                                show leaderboards and averages\n"
+         << "  " << program << " --stats-bench [games] [file]                  time recording simulated games\n"
+#endif
+         ;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 1) {
+        playInteractive();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--simulate") == 0) {
+        long long gamesPerLevel = argc > 2 ? atoll(argv[2]) : 1000000;
+        int threads = argc > 3 ? atoi(argv[3]) : static_cast<int>(thread::hardware_concurrency());
+        uint64_t seed = argc > 4 ? strtoull(argv[4], nullptr, 10) : random_device()();
+        cout << "Seed: " << seed << " (pass it again to replay this run)\n";
+
+        vector<unique_ptr<GuessStrategy>> strategies;
+        strategies.push_back(make_unique<BisectionStrategy>());
+        strategies.push_back(make_unique<RandomStrategy>());
+        strategies.push_back(make_unique<HintAwareStrategy>());
+
+        Simulator simulator(threads, seed);
+        for (const unique_ptr<GuessStrategy>& strategy : strategies)
+            simulator.run(*strategy, max(1LL, gamesPerLevel));
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--bench-rng") == 0) {
+        benchmarkPicker(argc > 2 ? strtoull(argv[2], nullptr, 10) : 50000000);
+        return 0;
+    }
+
+#ifdef __linux__
+    const string defaultSocket = "/tmp/guessing-game.sock";
+    if (strcmp(argv[1], "--serve") == 0) {
+        GameServer server(argc > 2 ? argv[2] : defaultSocket);
+        return server.run() ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--loadgen") == 0) {
+        LoadGenerator generator(argc > 2 ? argv[2] : defaultSocket,
+                                argc > 3 ? atoi(argv[3]) : 10000,
+                                argc > 4 ? atoi(argv[4]) : static_cast<int>(thread::hardware_concurrency()),
+                                argc > 5 ? atof(argv[5]) : 10.0);
+        generator.run();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--stats") == 0) {
+        StatsStore stats;
+        if (!stats.open(argc > 2 ? argv[2] : STATS_FILE)) {
+            cout << "Could not open the stats file.\n";
+            return 1;
+        }
+        stats.printReport();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--stats-bench") == 0) {
+        long long games = argc > 2 ? atoll(argv[2]) : 10000000;
+        // Without a file the run uses a new, empty scratch store in the
+        // temporary directory, never the player's own stats or other files
+        bool scratch = argc <= 3;
+        string path = scratch ? "" : argv[3];
+        if (scratch) {
+            const char* base = getenv("TMPDIR");
+            path = string(base && *base ? base : "/tmp") + "/guessing_bench.XXXXXX";
+            int fd = mkstemp(&path[0]);
+            if (fd < 0) {
+                cout << "Could not make a scratch stats file: " << strerror(errno) << "\n";
+                return 1;
+            }
+            close(fd);
+        }
+        auto start = chrono::steady_clock::now();
+        StatsStore stats;
+        if (!stats.open(path)) {
+            cout << "Could not open the stats file.\n";
+            if (scratch)
+                remove(path.c_str());
+            return 1;
+        }
+        double openSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Opened store with " << stats.gameCount() << " game(s) in " << openSeconds * 1e3 << " ms\n";
+
+        NumberPicker picker(1);
+        NumberGuesser game(picker);
+        HintAwareStrategy strategy;
+        start = chrono::steady_clock::now();
+        for (long long i = 0; i < games; i++) {
+            int level = static_cast<int>(i % LEVEL_COUNT);
+            GameOutcome outcome = game.playHeadless(LEVELS[level], strategy);
+            stats.record(level, outcome.guessesUsed, outcome.won, time(nullptr));
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Played and recorded " << games << " game(s) in " << seconds << "s ("
+             << (seconds > 0 ? games / seconds : 0.0) << " games/sec)\n";
+        stats.close();
+        if (scratch)
+            remove(path.c_str());
+        return 0;
+    }
+#endif
+
+    printUsage(argv[0]);
+    return 1;
+}
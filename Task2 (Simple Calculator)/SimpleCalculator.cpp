@@ -3,6 +3,32 @@
 #include <limits>
 #include <string>
 #include <cmath>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+#include <variant>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <charconv>
+#include <cerrno>
+#include <cstdio>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CALCULATOR_X86_SIMD 1
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 // This class helps us safely get numbers and choices from the user
@@ -44,96 +70,1306 @@ public:
     }
 };
 
+// Arbitrary-precision signed integer for exact whole-number calculations.
+// Values that fit in 64 bits stay inline in smallValue, so everyday numbers
+// cost no more than a long long; bigger ones switch to a little-endian
+// vector of 32-bit limbs. Multiplication goes Karatsuba above a size
+// threshold and division is Knuth's algorithm D. Division and remainder
+// truncate toward zero, like C++ integers.
+class BigInt {
+private:
+    using Limbs = vector<uint32_t>;
+
+    // Below this many limbs schoolbook multiplication wins
+    static const size_t KARATSUBA_THRESHOLD = 32;
+
+    bool small = true;
+    int64_t smallValue = 0;
+    bool negative = false; // Sign of a big value
+    Limbs limbs;           // Magnitude of a big value, no leading zero limbs
+
+    static void trim(Limbs& x) {
+        while (!x.empty() && x.back() == 0)
+            x.pop_back();
+    }
+
+    static int compareMagnitudes(const Limbs& a, const Limbs& b) {
+        if (a.size() != b.size())
+            return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0; )
+            if (a[i] != b[i])
+                return a[i] < b[i] ? -1 : 1;
+        return 0;
+    }
+
+    static Limbs addMagnitudes(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        if (na < nb) {
+            swap(a, b);
+            swap(na, nb);
+        }
+        Limbs sum(na + 1);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < na; i++) {
+            carry += uint64_t(a[i]) + (i < nb ? b[i] : 0);
+            sum[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        sum[na] = static_cast<uint32_t>(carry);
+        trim(sum);
+        return sum;
+    }
+
+    // x -= y, where x >= y
+    static void subtractInPlace(Limbs& x, const uint32_t* y, size_t ny) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < x.size(); i++) {
+            int64_t difference = int64_t(x[i]) - (i < ny ? y[i] : 0) - borrow;
+            borrow = difference < 0;
+            x[i] = static_cast<uint32_t>(difference);
+            if (i >= ny && !borrow)
+                break;
+        }
+        trim(x);
+    }
+
+    // out[offset...] += x, growing out as needed
+    static void addAt(Limbs& out, size_t offset, const Limbs& x) {
+        if (out.size() < offset + x.size() + 1)
+            out.resize(offset + x.size() + 1, 0);
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < x.size(); i++) {
+            carry += uint64_t(out[offset + i]) + x[i];
+            out[offset + i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        for (size_t k = offset + i; carry; k++) {
+            if (k == out.size())
+                out.push_back(0);
+            carry += out[k];
+            out[k] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    static Limbs multiplySchoolbook(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        Limbs product(na + nb, 0);
+        for (size_t i = 0; i < na; i++) {
+            uint64_t carry = 0;
+            uint64_t digit = a[i];
+            for (size_t j = 0; j < nb; j++) {
+                carry += digit * b[j] + product[i + j];
+                product[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            product[i + nb] = static_cast<uint32_t>(carry);
+        }
+        trim(product);
+        return product;
+    }
+
+    static Limbs multiplyMagnitudes(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+        if (na < nb) {
+            swap(a, b);
+            swap(na, nb);
+        }
+        if (nb == 0)
+            return Limbs();
+        if (nb < KARATSUBA_THRESHOLD)
+            return multiplySchoolbook(a, na, b, nb);
+
+        Limbs product;
+        if (2 * nb <= na) {
+            // Very different sizes: multiply b by one b-sized slice of a at a time
+            for (size_t offset = 0; offset < na; offset += nb)
+                addAt(product, offset, multiplyMagnitudes(a + offset, min(nb, na - offset), b, nb));
+            trim(product);
+            return product;
+        }
+
+        // a = a1 * B^half + a0, b = b1 * B^half + b0, and then
+        // a * b = z2 * B^(2 half) + (z1 - z2 - z0) * B^half + z0
+        size_t half = na / 2;
+        Limbs z0 = multiplyMagnitudes(a, half, b, half);
+        Limbs z2 = multiplyMagnitudes(a + half, na - half, b + half, nb - half);
+        Limbs aSum = addMagnitudes(a, half, a + half, na - half);
+        Limbs bSum = addMagnitudes(b, half, b + half, nb - half);
+        Limbs z1 = multiplyMagnitudes(aSum.data(), aSum.size(), bSum.data(), bSum.size());
+        subtractInPlace(z1, z0.data(), z0.size());
+        subtractInPlace(z1, z2.data(), z2.size());
+
+        product = z0;
+        addAt(product, half, z1);
+        addAt(product, 2 * half, z2);
+        trim(product);
+        return product;
+    }
+
+    // x /= divisor in place; returns the remainder
+    static uint32_t divideBySmall(Limbs& x, uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t i = x.size(); i-- > 0; ) {
+            uint64_t current = (remainder << 32) | x[i];
+            x[i] = static_cast<uint32_t>(current / divisor);
+            remainder = current % divisor;
+        }
+        trim(x);
+        return static_cast<uint32_t>(remainder);
+    }
+
+    // Knuth's algorithm D (as laid out in Hacker's Delight): a = q * b + r
+    static void divideMagnitudes(const Limbs& a, const Limbs& b, Limbs& quotient, Limbs& remainder) {
+        if (compareMagnitudes(a, b) < 0) {
+            quotient.clear();
+            remainder = a;
+            return;
+        }
+        if (b.size() == 1) {
+            quotient = a;
+            uint32_t r = divideBySmall(quotient, b[0]);
+            remainder.assign(r ? 1 : 0, r);
+            return;
+        }
+
+        size_t n = b.size(), m = a.size() - n;
+        // Normalise so the divisor's top limb has its high bit set
+        int shift = __builtin_clz(b.back());
+        Limbs vn(n), un(a.size() + 1);
+        for (size_t i = n - 1; i > 0; i--)
+            vn[i] = (b[i] << shift) | (shift ? uint32_t(uint64_t(b[i - 1]) >> (32 - shift)) : 0);
+        vn[0] = b[0] << shift;
+        un[a.size()] = shift ? uint32_t(uint64_t(a.back()) >> (32 - shift)) : 0;
+        for (size_t i = a.size() - 1; i > 0; i--)
+            un[i] = (a[i] << shift) | (shift ? uint32_t(uint64_t(a[i - 1]) >> (32 - shift)) : 0);
+        un[0] = a[0] << shift;
+
+        const uint64_t base = 1ULL << 32;
+        quotient.assign(m + 1, 0);
+        for (size_t j = m + 1; j-- > 0; ) {
+            uint64_t top = (uint64_t(un[j + n]) << 32) | un[j + n - 1];
+            uint64_t qhat = top / vn[n - 1];
+            uint64_t rhat = top % vn[n - 1];
+            while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                qhat--;
+                rhat += vn[n - 1];
+                if (rhat >= base)
+                    break;
+            }
+
+            // Subtract qhat * divisor from the current window
+            int64_t borrow = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t product = qhat * vn[i];
+                int64_t t = int64_t(un[i + j]) - borrow - int64_t(product & 0xFFFFFFFFULL);
+                un[i + j] = static_cast<uint32_t>(t);
+                borrow = int64_t(product >> 32) - (t >> 32);
+            }
+            int64_t t = int64_t(un[j + n]) - borrow;
+            un[j + n] = static_cast<uint32_t>(t);
+
+            if (t < 0) {
+                // qhat was one too large (rare): add the divisor back
+                qhat--;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; i++) {
+                    carry += uint64_t(un[i + j]) + vn[i];
+                    un[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                un[j + n] += static_cast<uint32_t>(carry);
+            }
+            quotient[j] = static_cast<uint32_t>(qhat);
+        }
+        trim(quotient);
+
+        remainder.assign(n, 0);
+        for (size_t i = 0; i < n; i++)
+            remainder[i] = (un[i] >> shift) | (shift ? uint32_t(uint64_t(un[i + 1]) << (32 - shift)) : 0);
+        trim(remainder);
+    }
+
+    // The magnitude of this value as limbs, whichever form it is in
+    Limbs magnitude() const {
+        if (!small)
+            return limbs;
+        uint64_t value = smallValue < 0 ? 0 - static_cast<uint64_t>(smallValue) : static_cast<uint64_t>(smallValue);
+        Limbs result;
+        if (value) result.push_back(static_cast<uint32_t>(value));
+        if (value >> 32) result.push_back(static_cast<uint32_t>(value >> 32));
+        return result;
+    }
+
+    // Builds a value from a sign and magnitude, going back inline if it fits
+    static BigInt fromMagnitude(Limbs magnitude, bool isNegative) {
+        trim(magnitude);
+        BigInt result;
+        if (magnitude.size() <= 2) {
+            uint64_t value = magnitude.empty() ? 0 : magnitude[0];
+            if (magnitude.size() == 2)
+                value |= uint64_t(magnitude[1]) << 32;
+            if (!isNegative && value <= uint64_t(numeric_limits<int64_t>::max())) {
+                result.smallValue = static_cast<int64_t>(value);
+                return result;
+            }
+            if (isNegative && value <= uint64_t(numeric_limits<int64_t>::max()) + 1) {
+                result.smallValue = static_cast<int64_t>(0 - value);
+                return result;
+            }
+        }
+        result.small = false;
+        result.negative = isNegative;
+        result.limbs = move(magnitude);
+        return result;
+    }
+
+    // Adds a and b, where b's sign has already been flipped for subtraction
+    static BigInt addSigned(const BigInt& a, const BigInt& b, bool bNegative) {
+        Limbs x = a.magnitude(), y = b.magnitude();
+        bool aNegative = a.isNegative();
+        if (aNegative == bNegative)
+            return fromMagnitude(addMagnitudes(x.data(), x.size(), y.data(), y.size()), aNegative);
+        int order = compareMagnitudes(x, y);
+        if (order == 0)
+            return BigInt();
+        if (order > 0) {
+            subtractInPlace(x, y.data(), y.size());
+            return fromMagnitude(move(x), aNegative);
+        }
+        subtractInPlace(y, x.data(), x.size());
+        return fromMagnitude(move(y), bNegative);
+    }
+
+public:
+    BigInt() = default;
+    BigInt(long long value) : smallValue(value) {}
+
+    // Parses an optionally signed decimal integer; throws on anything else
+    static BigInt parse(const string& text) {
+        size_t position = 0;
+        bool isNegative = false;
+        if (position < text.size() && (text[position] == '-' || text[position] == '+'))
+            isNegative = text[position++] == '-';
+        if (position == text.size())
+            throw runtime_error("'" + text + "' is not a whole number.");
+        for (size_t i = position; i < text.size(); i++)
+            if (!isdigit(static_cast<unsigned char>(text[i])))
+                throw runtime_error("'" + text + "' is not a whole number.");
+
+        // Nine digits at a time: magnitude = magnitude * 10^9 + chunk
+        Limbs magnitude;
+        size_t firstChunk = (text.size() - position) % 9;
+        if (firstChunk == 0) firstChunk = 9;
+        for (size_t i = position; i < text.size(); ) {
+            size_t length = (i == position) ? firstChunk : 9;
+            uint64_t carry = stoul(text.substr(i, length));
+            uint64_t scale = 1;
+            for (size_t k = 0; k < length; k++) scale *= 10;
+            for (uint32_t& limb : magnitude) {
+                carry += limb * scale;
+                limb = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            if (carry) magnitude.push_back(static_cast<uint32_t>(carry));
+            i += length;
+        }
+        return fromMagnitude(move(magnitude), isNegative);
+    }
+
+    string toString() const {
+        if (small)
+            return to_string(smallValue);
+        Limbs rest = limbs;
+        vector<uint32_t> chunks; // Base 10^9 digits, least significant first
+        while (!rest.empty())
+            chunks.push_back(divideBySmall(rest, 1000000000));
+
+        string text = negative ? "-" : "";
+        text += to_string(chunks.back());
+        char digits[16];
+        for (size_t i = chunks.size() - 1; i-- > 0; ) {
+            snprintf(digits, sizeof(digits), "%09u", chunks[i]);
+            text += digits;
+        }
+        return text;
+    }
+
+    bool isNegative() const { return small ? smallValue < 0 : negative; }
+    bool isZero() const { return small && smallValue == 0; }
+    bool isInline() const { return small; }
+
+    // Truncating division: a = quotient * b + remainder, |remainder| < |b|
+    static void divide(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+        if (b.isZero())
+            throw runtime_error("Division by zero is not allowed.");
+        if (a.small && b.small && !(a.smallValue == numeric_limits<int64_t>::min() && b.smallValue == -1)) {
+            quotient = BigInt(a.smallValue / b.smallValue);
+            remainder = BigInt(a.smallValue % b.smallValue);
+            return;
+        }
+        Limbs q, r;
+        divideMagnitudes(a.magnitude(), b.magnitude(), q, r);
+        quotient = fromMagnitude(move(q), a.isNegative() != b.isNegative());
+        remainder = fromMagnitude(move(r), a.isNegative());
+    }
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b) {
+        long long sum;
+        if (a.small && b.small && !__builtin_add_overflow(a.smallValue, b.smallValue, &sum))
+            return BigInt(sum);
+        return addSigned(a, b, b.isNegative());
+    }
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b) {
+        long long difference;
+        if (a.small && b.small && !__builtin_sub_overflow(a.smallValue, b.smallValue, &difference))
+            return BigInt(difference);
+        return addSigned(a, b, !b.isNegative() && !b.isZero());
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        long long product;
+        if (a.small && b.small && !__builtin_mul_overflow(a.smallValue, b.smallValue, &product))
+            return BigInt(product);
+        Limbs x = a.magnitude(), y = b.magnitude();
+        return fromMagnitude(multiplyMagnitudes(x.data(), x.size(), y.data(), y.size()),
+                             a.isNegative() != b.isNegative());
+    }
+
+    friend BigInt operator/(const BigInt& a, const BigInt& b) {
+        BigInt quotient, remainder;
+        divide(a, b, quotient, remainder);
+        return quotient;
+    }
+
+    friend BigInt operator%(const BigInt& a, const BigInt& b) {
+        BigInt quotient, remainder;
+        divide(a, b, quotient, remainder);
+        return remainder;
+    }
+
+    friend bool operator==(const BigInt& a, const BigInt& b) {
+        if (a.small != b.small)
+            return false; // Both forms are canonical, so they never overlap
+        return a.small ? a.smallValue == b.smallValue : (a.negative == b.negative && a.limbs == b.limbs);
+    }
+
+    friend bool operator!=(const BigInt& a, const BigInt& b) { return !(a == b); }
+};
+
+// Why one element of a batch calculation has no result
+enum class LaneError : uint8_t {
+    None = 0,
+    DivisionByZero,  // Division or modulus by zero
+    NotWholeNumber,  // Modulus of a number with a fractional part
+    Failed,          // Any other error thrown by the operation
+};
+
+// Describes a lane error the same way the single-value operations do
+const char* describeLaneError(LaneError error) {
+    switch (error) {
+        case LaneError::None: return "OK";
+        case LaneError::DivisionByZero: return "Division by zero is not allowed.";
+        case LaneError::NotWholeNumber: return "Modulus only works with whole numbers.";
+        case LaneError::Failed: return "Calculation failed.";
+    }
+    return "Calculation failed.";
+}
+
+// Vectorised kernels for the batch operations. AVX2 is picked at run time
+// when the CPU has it; SSE2 is always there on x86-64; other targets get
+// plain loops, which the compiler can still vectorise on its own.
+enum class BatchKind { Add, Subtract, Multiply, Divide };
+
+#ifdef CALCULATOR_X86_SIMD
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+template <BatchKind kind>
+__attribute__((target("avx2"))) size_t avx2Kernel(const double* a, const double* b, double* out, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        __m256d y = _mm256_loadu_pd(b + i);
+        __m256d r;
+        if constexpr (kind == BatchKind::Add) r = _mm256_add_pd(x, y);
+        else if constexpr (kind == BatchKind::Subtract) r = _mm256_sub_pd(x, y);
+        else if constexpr (kind == BatchKind::Multiply) r = _mm256_mul_pd(x, y);
+        else r = _mm256_div_pd(x, y);
+        _mm256_storeu_pd(out + i, r);
+    }
+    return i;
+}
+
+template <BatchKind kind>
+size_t sse2Kernel(const double* a, const double* b, double* out, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i);
+        __m128d y = _mm_loadu_pd(b + i);
+        __m128d r;
+        if constexpr (kind == BatchKind::Add) r = _mm_add_pd(x, y);
+        else if constexpr (kind == BatchKind::Subtract) r = _mm_sub_pd(x, y);
+        else if constexpr (kind == BatchKind::Multiply) r = _mm_mul_pd(x, y);
+        else r = _mm_div_pd(x, y);
+        _mm_storeu_pd(out + i, r);
+    }
+    return i;
+}
+
+// Skips over groups of four divisors that are all non-zero; returns where
+// the first group containing a zero (or the unvectorised tail) starts
+__attribute__((target("avx2"))) size_t avx2SkipNonZero(const double* b, size_t count) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(b + i), zero, _CMP_EQ_OQ)))
+            break;
+    return i;
+}
+
+// Remainder of whole numbers in [-2^31, 2^31] done in doubles: in that range
+// trunc(a / b) is always the exact integer quotient, so a - q * b is exact.
+// Returns how many elements were handled; the rest need the scalar path.
+__attribute__((target("avx2"))) size_t avx2WholeModulus(const double* a, const double* b, double* out, size_t count) {
+    const __m256d limit = _mm256_set1_pd(2147483648.0);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i);
+        __m256d y = _mm256_loadu_pd(b + i);
+        __m256d whole = _mm256_and_pd(
+            _mm256_cmp_pd(_mm256_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), x, _CMP_EQ_OQ),
+            _mm256_cmp_pd(_mm256_round_pd(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC), y, _CMP_EQ_OQ));
+        __m256d small = _mm256_and_pd(_mm256_cmp_pd(_mm256_andnot_pd(signMask, x), limit, _CMP_LE_OQ),
+                                      _mm256_cmp_pd(_mm256_andnot_pd(signMask, y), limit, _CMP_LE_OQ));
+        __m256d ok = _mm256_and_pd(_mm256_and_pd(whole, small), _mm256_cmp_pd(y, zero, _CMP_NEQ_OQ));
+        if (_mm256_movemask_pd(ok) != 0xF)
+            break; // Let the scalar path sort out this group's errors and big values
+        __m256d quotient = _mm256_round_pd(_mm256_div_pd(x, y), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(x, _mm256_mul_pd(quotient, y)));
+    }
+    return i;
+}
+#endif
+
+// Runs one of the element-wise kernels over the whole batch
+template <BatchKind kind>
+void runBatchKernel(const double* a, const double* b, double* out, size_t count) {
+    size_t done = 0;
+#ifdef CALCULATOR_X86_SIMD
+    done = cpuHasAvx2() ? avx2Kernel<kind>(a, b, out, count) : sse2Kernel<kind>(a, b, out, count);
+#endif
+    for (size_t i = done; i < count; i++) {
+        if constexpr (kind == BatchKind::Add) out[i] = a[i] + b[i];
+        else if constexpr (kind == BatchKind::Subtract) out[i] = a[i] - b[i];
+        else if constexpr (kind == BatchKind::Multiply) out[i] = a[i] * b[i];
+        else out[i] = a[i] / b[i];
+    }
+}
+
+// Compile-time facts about an operation, used for menus and results
+struct OperationInfo {
+    const char* name;
+    char symbol;
+};
+
 // A general blueprint for doing math operations
 class Operation {
 public:
     virtual ~Operation() = default;
     virtual double execute(double a, double b) const = 0; // Perform the operation
-    virtual string getName() const = 0; // Return the name of the operation
+    virtual const char* getName() const = 0; // Return the name of the operation
+
+    // Performs the operation on count pairs at once: out[i] = a[i] op b[i].
+    // Nothing is thrown; a failed element gets NaN in out and its reason in
+    // errors[i] (errors may be null if the caller does not care).
+    // Returns the number of failed elements.
+    virtual size_t execute(const double* a, const double* b, double* out, LaneError* errors, size_t count) const {
+        size_t failures = 0;
+        for (size_t i = 0; i < count; i++) {
+            LaneError error = LaneError::None;
+            try {
+                out[i] = execute(a[i], b[i]);
+            } catch (const runtime_error&) {
+                out[i] = numeric_limits<double>::quiet_NaN();
+                error = LaneError::Failed;
+                failures++;
+            }
+            if (errors) errors[i] = error;
+        }
+        return failures;
+    }
 };
 
 // This one adds two numbers
-class Addition : public Operation {
+class Addition final : public Operation {
 public:
+    using Operation::execute;
     double execute(double a, double b) const override {
         return a + b;
     }
-    string getName() const override {
-        return "Addition";
+    BigInt execute(const BigInt& a, const BigInt& b) const {
+        return a + b;
+    }
+    size_t execute(const double* a, const double* b, double* out, LaneError* errors, size_t count) const override {
+        runBatchKernel<BatchKind::Add>(a, b, out, count);
+        if (errors) memset(errors, 0, count * sizeof(LaneError));
+        return 0;
+    }
+    static constexpr OperationInfo info{"Addition", '+'};
+    const char* getName() const override {
+        return info.name;
     }
 };
 
 // This one subtracts the second number from the first
-class Subtraction : public Operation {
+class Subtraction final : public Operation {
 public:
+    using Operation::execute;
     double execute(double a, double b) const override {
         return a - b;
     }
-    string getName() const override {
-        return "Subtraction";
+    BigInt execute(const BigInt& a, const BigInt& b) const {
+        return a - b;
+    }
+    size_t execute(const double* a, const double* b, double* out, LaneError* errors, size_t count) const override {
+        runBatchKernel<BatchKind::Subtract>(a, b, out, count);
+        if (errors) memset(errors, 0, count * sizeof(LaneError));
+        return 0;
+    }
+    static constexpr OperationInfo info{"Subtraction", '-'};
+    const char* getName() const override {
+        return info.name;
     }
 };
 
 // This multiplies two numbers together
-class Multiplication : public Operation {
+class Multiplication final : public Operation {
 public:
+    using Operation::execute;
     double execute(double a, double b) const override {
         return a * b;
     }
-    string getName() const override {
-        return "Multiplication";
+    BigInt execute(const BigInt& a, const BigInt& b) const {
+        return a * b;
+    }
+    size_t execute(const double* a, const double* b, double* out, LaneError* errors, size_t count) const override {
+        runBatchKernel<BatchKind::Multiply>(a, b, out, count);
+        if (errors) memset(errors, 0, count * sizeof(LaneError));
+        return 0;
+    }
+    static constexpr OperationInfo info{"Multiplication", '*'};
+    const char* getName() const override {
+        return info.name;
     }
 };
 
 // This divides one number by another, carefully avoiding division by zero
-class Division : public Operation {
+class Division final : public Operation {
 public:
+    using Operation::execute;
     double execute(double a, double b) const override {
         if (b == 0) throw runtime_error("Division by zero is not allowed.");
         return a / b;
     }
-    string getName() const override {
-        return "Division";
+    // Exact division only makes sense when the answer is a whole number
+    BigInt execute(const BigInt& a, const BigInt& b) const {
+        if (b.isZero()) throw runtime_error("Division by zero is not allowed.");
+        BigInt quotient, remainder;
+        BigInt::divide(a, b, quotient, remainder);
+        if (!remainder.isZero())
+            throw runtime_error("The result is not a whole number (remainder " + remainder.toString() + ").");
+        return quotient;
+    }
+    size_t execute(const double* a, const double* b, double* out, LaneError* errors, size_t count) const override {
+        // Divide everything first, then patch up the (rare) zero divisors
+        runBatchKernel<BatchKind::Divide>(a, b, out, count);
+        if (errors) memset(errors, 0, count * sizeof(LaneError));
+        size_t failures = 0;
+        size_t i = 0;
+        while (i < count) {
+#ifdef CALCULATOR_X86_SIMD
+            if (cpuHasAvx2())
+                i += avx2SkipNonZero(b + i, count - i);
+#endif
+            size_t groupEnd = min(count, i + 4);
+            for (; i < groupEnd; i++) {
+                if (b[i] == 0) {
+                    out[i] = numeric_limits<double>::quiet_NaN();
+                    if (errors) errors[i] = LaneError::DivisionByZero;
+                    failures++;
+                }
+            }
+        }
+        return failures;
+    }
+    static constexpr OperationInfo info{"Division", '/'};
+    const char* getName() const override {
+        return info.name;
     }
 };
 
 // This finds the remainder when one whole number is divided by another
-class Modulus : public Operation {
-public:
-    double execute(double a, double b) const override {
+class Modulus final : public Operation {
+private:
+    // Checks one pair and works out its remainder with integer arithmetic
+    static LaneError remainder(double a, double b, double& out) {
         if (floor(a) != a || floor(b) != b)
-            throw runtime_error("Modulus only works with whole numbers.");
+            return LaneError::NotWholeNumber;
         if (b == 0)
-            throw runtime_error("Modulus by zero is not allowed.");
-        return static_cast<long long>(a) % static_cast<long long>(b);
+            return LaneError::DivisionByZero;
+        if (fabs(a) < 9.2e18 && fabs(b) < 9.2e18)
+            out = static_cast<double>(static_cast<long long>(a) % static_cast<long long>(b));
+        else
+            out = fmod(a, b); // Too big for long long; fmod is exact for whole doubles
+        return LaneError::None;
+    }
+
+public:
+    using Operation::execute;
+    double execute(double a, double b) const override {
+        double result = 0;
+        switch (remainder(a, b, result)) {
+            case LaneError::NotWholeNumber:
+                throw runtime_error("Modulus only works with whole numbers.");
+            case LaneError::DivisionByZero:
+                throw runtime_error("Modulus by zero is not allowed.");
+            default:
+                return result;
+        }
+    }
+    BigInt execute(const BigInt& a, const BigInt& b) const {
+        if (b.isZero()) throw runtime_error("Modulus by zero is not allowed.");
+        return a % b;
+    }
+    size_t execute(const double* a, const double* b, double* out, LaneError* errors, size_t count) const override {
+        size_t failures = 0;
+        size_t i = 0;
+        while (i < count) {
+            // Fast path: whole groups of small whole numbers, all lanes at once
+#ifdef CALCULATOR_X86_SIMD
+            if (cpuHasAvx2()) {
+                size_t done = avx2WholeModulus(a + i, b + i, out + i, count - i);
+                if (errors) memset(errors + i, 0, done * sizeof(LaneError));
+                i += done;
+            }
+#endif
+            // Integer path for the group that stopped the fast path (or everything)
+            size_t groupEnd = min(count, i + 4);
+            for (; i < groupEnd; i++) {
+                LaneError error = remainder(a[i], b[i], out[i]);
+                if (error != LaneError::None) {
+                    out[i] = numeric_limits<double>::quiet_NaN();
+                    failures++;
+                }
+                if (errors) errors[i] = error;
+            }
+        }
+        return failures;
+    }
+    static constexpr OperationInfo info{"Modulus", '%'};
+    const char* getName() const override {
+        return info.name;
+    }
+};
+
+// Any one of the calculator's operations, stored by value. The classes are
+// final, so calls made through visit() are bound at compile time and can be
+// inlined instead of going through the vtable.
+using AnyOperation = variant<Addition, Subtraction, Multiplication, Division, Modulus>;
+
+// Name and symbol of every operation, in menu order (choice 1 is index 0)
+constexpr OperationInfo OPERATION_INFO[] = {
+    Addition::info, Subtraction::info, Multiplication::info, Division::info, Modulus::info,
+};
+constexpr int OPERATION_COUNT = sizeof(OPERATION_INFO) / sizeof(OPERATION_INFO[0]);
+static_assert(variant_size_v<AnyOperation> == OPERATION_COUNT, "every operation needs its info");
+
+// Builds the operation for a menu choice (1-5), without touching the heap
+AnyOperation makeOperation(int choice) {
+    switch (choice) {
+        case 2: return Subtraction();
+        case 3: return Multiplication();
+        case 4: return Division();
+        case 5: return Modulus();
+        default: return Addition();
+    }
+}
+
+// Runs whichever operation is stored, with a direct call
+inline double applyOperation(const AnyOperation& operation, double a, double b) {
+    return visit([a, b](const auto& op) { return op.execute(a, b); }, operation);
+}
+
+// Same, with exact whole numbers of any size
+inline BigInt applyOperation(const AnyOperation& operation, const BigInt& a, const BigInt& b) {
+    return visit([&a, &b](const auto& op) { return op.execute(a, b); }, operation);
+}
+
+// One shared instance of each operation, so the expression VM can use them
+// as its opcode implementations without allocating anything
+const Addition ADDITION;
+const Subtraction SUBTRACTION;
+const Multiplication MULTIPLICATION;
+const Division DIVISION;
+const Modulus MODULUS;
+
+// The same operations in menu order, for code that works on any of them
+const Operation* const BINARY_OPERATIONS[] = {&ADDITION, &SUBTRACTION, &MULTIPLICATION, &DIVISION, &MODULUS};
+
+// Applies the index-th operation (menu order) with a direct call
+inline double applyOperation(uint32_t index, double a, double b) {
+    switch (index) {
+        case 0: return ADDITION.execute(a, b);
+        case 1: return SUBTRACTION.execute(a, b);
+        case 2: return MULTIPLICATION.execute(a, b);
+        case 3: return DIVISION.execute(a, b);
+        default: return MODULUS.execute(a, b);
+    }
+}
+
+// Functions of one argument that expressions may call, e.g. sqrt(x)
+struct UnaryFunction {
+    const char* name;
+    double (*apply)(double);
+};
+
+const UnaryFunction UNARY_FUNCTIONS[] = {
+    {"abs", [](double x) { return fabs(x); }},
+    {"sqrt", [](double x) { return sqrt(x); }},
+    {"exp", [](double x) { return exp(x); }},
+    {"log", [](double x) { return log(x); }},
+    {"sin", [](double x) { return sin(x); }},
+    {"cos", [](double x) { return cos(x); }},
+    {"tan", [](double x) { return tan(x); }},
+    {"floor", [](double x) { return floor(x); }},
+    {"ceil", [](double x) { return ceil(x); }},
+};
+const int UNARY_FUNCTION_COUNT = sizeof(UNARY_FUNCTIONS) / sizeof(UNARY_FUNCTIONS[0]);
+
+// Instructions of the expression virtual machine. It is a stack machine:
+// operands are pushed, and operators replace the top values with the result.
+enum class OpCode : uint8_t {
+    PushConstant, // Push constants[operand]
+    PushVariable, // Push variables[operand]
+    Binary,       // Pop b and a, push the result of operation number operand on them
+    Negate,       // Flip the sign of the top value
+    Call,         // Apply UNARY_FUNCTIONS[operand] to the top value
+};
+
+struct Instruction {
+    OpCode op;
+    uint32_t operand;
+};
+
+// An expression compiled to bytecode once, ready to be evaluated many times
+// with different variable values. Evaluation never allocates.
+class CompiledExpression {
+public:
+    // Deepest stack any expression may need; keeps the VM stack on the C++ stack
+    static const int MAX_STACK_DEPTH = 64;
+
+private:
+    vector<Instruction> code;
+    vector<double> constants;
+    vector<string> variables;
+    int stackDepth = 0;
+
+    friend class ExpressionParser;
+    friend class JitCompiler;
+
+public:
+    // Runs the bytecode; values[i] is the value of variable i
+    double evaluate(const double* values) const {
+        double stack[MAX_STACK_DEPTH];
+        int top = -1;
+        for (const Instruction& instruction : code) {
+            switch (instruction.op) {
+                case OpCode::PushConstant:
+                    stack[++top] = constants[instruction.operand];
+                    break;
+                case OpCode::PushVariable:
+                    stack[++top] = values[instruction.operand];
+                    break;
+                case OpCode::Binary:
+                    stack[top - 1] = applyOperation(instruction.operand, stack[top - 1], stack[top]);
+                    top--;
+                    break;
+                case OpCode::Negate:
+                    stack[top] = -stack[top];
+                    break;
+                case OpCode::Call:
+                    stack[top] = UNARY_FUNCTIONS[instruction.operand].apply(stack[top]);
+                    break;
+            }
+        }
+        return stack[0];
     }
-    string getName() const override {
-        return "Modulus";
+
+    double evaluate(const vector<double>& values) const {
+        if (values.size() != variables.size())
+            throw runtime_error("Expected " + to_string(variables.size()) + " variable value(s).");
+        return evaluate(values.data());
+    }
+
+    // Variable names in slot order, as they first appear in the expression
+    const vector<string>& getVariables() const { return variables; }
+    size_t getInstructionCount() const { return code.size(); }
+
+    // Human-readable listing of the bytecode, one instruction per line
+    string disassemble() const {
+        string listing;
+        for (const Instruction& instruction : code) {
+            switch (instruction.op) {
+                case OpCode::PushConstant:
+                    listing += "push " + to_string(constants[instruction.operand]) + "\n";
+                    break;
+                case OpCode::PushVariable:
+                    listing += "load " + variables[instruction.operand] + "\n";
+                    break;
+                case OpCode::Binary:
+                    listing += string(OPERATION_INFO[instruction.operand].name) + "\n";
+                    break;
+                case OpCode::Negate:
+                    listing += "negate\n";
+                    break;
+                case OpCode::Call:
+                    listing += string("call ") + UNARY_FUNCTIONS[instruction.operand].name + "\n";
+                    break;
+            }
+        }
+        return listing;
+    }
+};
+
+// Turns text such as "2 * (x + 1) % 3 - sqrt(y)" into a CompiledExpression.
+// Usual precedence: unary minus, then * / %, then + -, all left-associative.
+class ExpressionParser {
+private:
+    // Deepest run of signs, brackets and calls; bounds the parser's recursion
+    static const int MAX_NESTING = 256;
+
+    string text;
+    size_t position = 0;
+    CompiledExpression result;
+    int depth = 0;
+    int nesting = 0;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw runtime_error(message + " (at position " + to_string(position + 1) + ")");
+    }
+
+    void skipSpaces() {
+        while (position < text.size() && isspace(static_cast<unsigned char>(text[position])))
+            position++;
+    }
+
+    bool accept(char c) {
+        skipSpaces();
+        if (position < text.size() && text[position] == c) {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    // Appends an instruction and tracks how deep the stack gets
+    void emit(OpCode op, uint32_t operand, int stackChange) {
+        result.code.push_back({op, operand});
+        depth += stackChange;
+        if (depth > CompiledExpression::MAX_STACK_DEPTH)
+            fail("Expression is nested too deeply");
+        result.stackDepth = max(result.stackDepth, depth);
+    }
+
+    void emitBinary(char symbol) {
+        for (int i = 0; i < OPERATION_COUNT; i++)
+            if (OPERATION_INFO[i].symbol == symbol)
+                emit(OpCode::Binary, static_cast<uint32_t>(i), -1);
+    }
+
+    uint32_t variableSlot(const string& name) {
+        for (size_t i = 0; i < result.variables.size(); i++)
+            if (result.variables[i] == name)
+                return static_cast<uint32_t>(i);
+        result.variables.push_back(name);
+        return static_cast<uint32_t>(result.variables.size() - 1);
+    }
+
+    // sum := product (('+' | '-') product)*
+    void parseSum() {
+        parseProduct();
+        while (true) {
+            if (accept('+')) { parseProduct(); emitBinary('+'); }
+            else if (accept('-')) { parseProduct(); emitBinary('-'); }
+            else return;
+        }
+    }
+
+    // product := unary (('*' | '/' | '%') unary)*
+    void parseProduct() {
+        parseUnary();
+        while (true) {
+            if (accept('*')) { parseUnary(); emitBinary('*'); }
+            else if (accept('/')) { parseUnary(); emitBinary('/'); }
+            else if (accept('%')) { parseUnary(); emitBinary('%'); }
+            else return;
+        }
+    }
+
+    // unary := ('-' | '+') unary | primary
+    void parseUnary() {
+        if (++nesting > MAX_NESTING)
+            fail("Expression is nested too deeply");
+        if (accept('-')) {
+            parseUnary();
+            emit(OpCode::Negate, 0, 0);
+        } else if (accept('+')) {
+            parseUnary();
+        } else {
+            parsePrimary();
+        }
+        nesting--;
+    }
+
+    // primary := number | name | name '(' sum ')' | '(' sum ')'
+    void parsePrimary() {
+        skipSpaces();
+        if (position >= text.size())
+            fail("Unexpected end of expression");
+
+        char c = text[position];
+        if (accept('(')) {
+            parseSum();
+            if (!accept(')'))
+                fail("Missing ')'");
+        } else if (isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* start = text.c_str() + position;
+            char* end = nullptr;
+            double value = strtod(start, &end);
+            if (end == start)
+                fail("Invalid number");
+            position += end - start;
+            result.constants.push_back(value);
+            emit(OpCode::PushConstant, static_cast<uint32_t>(result.constants.size() - 1), 1);
+        } else if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = position;
+            while (position < text.size() &&
+                   (isalnum(static_cast<unsigned char>(text[position])) || text[position] == '_'))
+                position++;
+            string name = text.substr(start, position - start);
+
+            if (accept('(')) {
+                int function = -1;
+                for (int i = 0; i < UNARY_FUNCTION_COUNT; i++)
+                    if (name == UNARY_FUNCTIONS[i].name)
+                        function = i;
+                if (function < 0)
+                    fail("Unknown function '" + name + "'");
+                parseSum();
+                if (!accept(')'))
+                    fail("Missing ')'");
+                emit(OpCode::Call, static_cast<uint32_t>(function), 0);
+            } else {
+                emit(OpCode::PushVariable, variableSlot(name), 1);
+            }
+        } else {
+            fail(string("Unexpected character '") + c + "'");
+        }
+    }
+
+public:
+    // Compiles the whole text; throws runtime_error describing the first problem
+    CompiledExpression compile(const string& expression) {
+        text = expression;
+        position = 0;
+        depth = 0;
+        nesting = 0;
+        result = CompiledExpression();
+
+        parseSum();
+        skipSpaces();
+        if (position != text.size())
+            fail("Unexpected '" + text.substr(position, 1) + "'");
+        return move(result);
+    }
+};
+
+#if defined(__linux__) && defined(__x86_64__)
+// A CompiledExpression translated to native x86-64 code. The VM stack is
+// mapped onto SSE registers (stack slot k lives in xmm k), so evaluation is
+// straight-line code with no dispatch at all. Only part of the language is
+// supported; JitCompiler::compile returns null for the rest, and callers
+// keep using the interpreter.
+class JitExpression {
+private:
+    // values in rdi, constants in rsi, error flag in rdx; result in xmm0
+    using NativeFunction = double (*)(const double* values, const double* constants, int* error);
+
+    void* memory = nullptr;
+    size_t memorySize = 0;
+    NativeFunction function = nullptr;
+    vector<double> constants;
+
+    friend class JitCompiler;
+
+public:
+    JitExpression() = default;
+    JitExpression(const JitExpression&) = delete;
+    JitExpression& operator=(const JitExpression&) = delete;
+
+    ~JitExpression() {
+        if (memory) munmap(memory, memorySize);
+    }
+
+    // Runs the native code; values[i] is the value of variable i
+    double evaluate(const double* values) const {
+        int error = 0;
+        double result = function(values, constants.data(), &error);
+        if (error)
+            throw runtime_error("Division by zero is not allowed.");
+        return result;
+    }
+
+    size_t getCodeSize() const { return memorySize; }
+};
+
+// Emits SSE2 machine code for CompiledExpression bytecode
+class JitCompiler {
+private:
+    // xmm14 and xmm15 are scratch, which leaves 14 registers for the stack
+    static const int REGISTER_STACK_DEPTH = 14;
+    static const int SCRATCH = 15;
+
+    vector<uint8_t> code;
+
+    void bytes(initializer_list<uint8_t> values) {
+        code.insert(code.end(), values);
+    }
+
+    // Writes the (optional) REX prefix for a register-to-register instruction
+    void rex(int reg, int rm, bool wide = false) {
+        uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | (reg >= 8 ? 0x04 : 0) | (rm >= 8 ? 0x01 : 0);
+        if (prefix != 0x40)
+            code.push_back(prefix);
+    }
+
+    // prefix [REX] 0F opcode with register operands dst, src
+    void registerOp(uint8_t prefix, uint8_t opcode, int dst, int src) {
+        code.push_back(prefix);
+        rex(dst, src);
+        bytes({0x0F, opcode, static_cast<uint8_t>(0xC0 | ((dst & 7) << 3) | (src & 7))});
+    }
+
+    // movsd xmm(dst), [base + displacement], base being rdi (7) or rsi (6)
+    void loadDouble(int dst, int base, uint32_t index) {
+        code.push_back(0xF2);
+        rex(dst, 0);
+        bytes({0x0F, 0x10, static_cast<uint8_t>(0x80 | ((dst & 7) << 3) | base)});
+        uint32_t displacement = index * sizeof(double);
+        for (int i = 0; i < 4; i++)
+            code.push_back(static_cast<uint8_t>(displacement >> (8 * i)));
+    }
+
+    // xmm15 = 64-bit constant, via rax
+    void loadScratchBits(uint64_t bits) {
+        bytes({0x48, 0xB8});
+        for (int i = 0; i < 8; i++)
+            code.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+        bytes({0x66, 0x4C, 0x0F, 0x6E, static_cast<uint8_t>(0xC0 | ((SCRATCH & 7) << 3))}); // movq xmm15, rax
+    }
+
+    // If xmm(divisor) is zero, set *error and return; NaN divisors carry on
+    void checkDivisor(int divisor) {
+        registerOp(0x66, 0x57, SCRATCH, SCRATCH);   // xorpd xmm15, xmm15
+        registerOp(0x66, 0x2E, divisor, SCRATCH);   // ucomisd xmm(divisor), xmm15
+        bytes({0x75, 0x09,                          // jne  ok
+               0x7A, 0x07,                          // jp   ok
+               0xC7, 0x02, 0x01, 0x00, 0x00, 0x00,  // mov dword [rdx], 1
+               0xC3});                              // ret
+    }
+
+    static bool hasSse41() {
+        static const bool supported = __builtin_cpu_supports("sse4.1");
+        return supported;
+    }
+
+public:
+    // Translates the bytecode; returns null if the expression uses something
+    // the native code generator does not handle (such as %, or sin())
+    unique_ptr<JitExpression> compile(const CompiledExpression& expression) {
+        if (expression.stackDepth > REGISTER_STACK_DEPTH)
+            return nullptr;
+
+        code.clear();
+        int top = -1;
+        for (const Instruction& instruction : expression.code) {
+            switch (instruction.op) {
+                case OpCode::PushConstant:
+                    loadDouble(++top, 6, instruction.operand);
+                    break;
+                case OpCode::PushVariable:
+                    loadDouble(++top, 7, instruction.operand);
+                    break;
+                case OpCode::Binary: {
+                    static const uint8_t opcodes[] = {0x58, 0x5C, 0x59, 0x5E}; // addsd subsd mulsd divsd
+                    if (instruction.operand >= sizeof(opcodes))
+                        return nullptr; // Modulus stays in the interpreter
+                    if (instruction.operand == 3)
+                        checkDivisor(top);
+                    registerOp(0xF2, opcodes[instruction.operand], top - 1, top);
+                    top--;
+                    break;
+                }
+                case OpCode::Negate:
+                    loadScratchBits(0x8000000000000000ULL);
+                    registerOp(0x66, 0x57, top, SCRATCH); // xorpd flips the sign bit
+                    break;
+                case OpCode::Call: {
+                    string name = UNARY_FUNCTIONS[instruction.operand].name;
+                    if (name == "sqrt") {
+                        registerOp(0xF2, 0x51, top, top);
+                    } else if (name == "abs") {
+                        loadScratchBits(0x7FFFFFFFFFFFFFFFULL);
+                        registerOp(0x66, 0x54, top, SCRATCH); // andpd clears the sign bit
+                    } else if ((name == "floor" || name == "ceil") && hasSse41()) {
+                        // roundsd xmm, xmm, mode (with precision exceptions suppressed)
+                        code.push_back(0x66);
+                        rex(top, top);
+                        bytes({0x0F, 0x3A, 0x0B, static_cast<uint8_t>(0xC0 | ((top & 7) << 3) | (top & 7)),
+                               static_cast<uint8_t>(name == "floor" ? 0x09 : 0x0A)});
+                    } else {
+                        return nullptr;
+                    }
+                    break;
+                }
+            }
+        }
+        code.push_back(0xC3); // ret, with the result already in xmm0
+
+        // Write the code into fresh pages, then make them executable (and no longer writable)
+        long pageSize = sysconf(_SC_PAGESIZE);
+        size_t size = (code.size() + pageSize - 1) / pageSize * pageSize;
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            return nullptr;
+        memcpy(memory, code.data(), code.size());
+        if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(memory, size);
+            return nullptr;
+        }
+
+        auto result = make_unique<JitExpression>();
+        result->memory = memory;
+        result->memorySize = size;
+        result->function = reinterpret_cast<JitExpression::NativeFunction>(memory);
+        result->constants = expression.constants;
+        return result;
+    }
+};
+
+// Times the interpreter against native code for one expression and says
+// after how many evaluations compiling to native code starts paying off
+void benchmarkJit(const string& text, size_t rows) {
+    CompiledExpression expression = ExpressionParser().compile(text);
+
+    auto start = chrono::steady_clock::now();
+    unique_ptr<JitExpression> native = JitCompiler().compile(expression);
+    double compileSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!native) {
+        cout << "This expression uses operations the JIT does not handle; it runs interpreted.\n";
+        return;
+    }
+
+    size_t width = max<size_t>(1, expression.getVariables().size());
+    vector<double> inputs(rows * width);
+    for (size_t i = 0; i < inputs.size(); i++)
+        inputs[i] = 1.0 + static_cast<double>(i % 1000) * 0.5;
+
+    double interpretedSum = 0, nativeSum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t row = 0; row < rows; row++)
+        interpretedSum += expression.evaluate(&inputs[row * width]);
+    double interpretedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (size_t row = 0; row < rows; row++)
+        nativeSum += native->evaluate(&inputs[row * width]);
+    double nativeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double interpretedEach = interpretedSeconds / rows, nativeEach = nativeSeconds / rows;
+    cout << fixed << setprecision(2)
+         << "JIT compile:  " << compileSeconds * 1e6 << " us (" << native->getCodeSize() << " byte code page)\n"
+         << "Interpreted:  " << interpretedEach * 1e9 << " ns per evaluation\n"
+         << "Native code:  " << nativeEach * 1e9 << " ns per evaluation\n";
+    if (interpretedEach > nativeEach)
+        cout << "JIT pays off after about " << setprecision(0) << compileSeconds / (interpretedEach - nativeEach)
+             << " evaluations\n";
+    else
+        cout << "The JIT did not beat the interpreter here\n";
+    cout << resetiosflags(ios::fixed) << setprecision(6)
+         << (interpretedSum == nativeSum ? "Results match.\n" : "RESULTS DIFFER!\n");
+}
+#endif
+
+// An expression ready to be evaluated many times: as native code where the
+// JIT is available and handles it, otherwise by the bytecode interpreter
+class FastExpression {
+private:
+    CompiledExpression bytecode;
+#if defined(__linux__) && defined(__x86_64__)
+    unique_ptr<JitExpression> native;
+#endif
+
+public:
+    explicit FastExpression(const string& text) : bytecode(ExpressionParser().compile(text)) {
+#if defined(__linux__) && defined(__x86_64__)
+        native = JitCompiler().compile(bytecode);
+#endif
+    }
+
+    // values[i] is the value of variable i
+    double evaluate(const double* values) const {
+#if defined(__linux__) && defined(__x86_64__)
+        if (native)
+            return native->evaluate(values);
+#endif
+        return bytecode.evaluate(values);
+    }
+
+    double evaluate(const vector<double>& values) const {
+        if (values.size() != bytecode.getVariables().size())
+            throw runtime_error("Expected " + to_string(bytecode.getVariables().size()) + " variable value(s).");
+        return evaluate(values.data());
+    }
+
+    const CompiledExpression& getBytecode() const { return bytecode; }
+
+    bool isNative() const {
+#if defined(__linux__) && defined(__x86_64__)
+        return native != nullptr;
+#else
+        return false;
+#endif
     }
 };
 
 // This is the heart of the calculator — it pulls everything together
 class Calculator {
 private:
-    InputHelper input;     // Helper for getting user input
-    double num1, num2;     // The two numbers for operations
-    Operation* operation;  // Pointer to the chosen operation
+    InputHelper input;       // Helper for getting user input
+    double num1 = 0, num2 = 0; // The two numbers for operations
+    AnyOperation operation;  // The chosen operation, stored in place
 
-    // Based on the user's choice, create the correct operation object
+    // Based on the user's choice, switch to the correct operation
     void setOperation(int choice) {
-        delete operation; // Clean up old operation
-        switch (choice) {
-            case 1: operation = new Addition(); break;
-            case 2: operation = new Subtraction(); break;
-            case 3: operation = new Multiplication(); break;
-            case 4: operation = new Division(); break;
-            case 5: operation = new Modulus(); break;
-        }
+        operation = makeOperation(choice);
     }
 
 public:
-    Calculator() : operation(nullptr) {} // Start with no operation
-    ~Calculator() { delete operation; }  // Free memory when done
 
     // This function handles one calculation session
     void runCalculation() {
@@ -143,33 +1379,599 @@ public:
         setOperation(choice); // Set the right operation
 
         try {
-            double result = operation->execute(num1, num2); // Try to calculate
+            double result = applyOperation(operation, num1, num2); // Try to calculate
+            const OperationInfo& info = OPERATION_INFO[operation.index()];
             cout << fixed << setprecision(0);
-            cout << "\nResult of " << operation->getName() << ":\n";
-            cout << num1 << " " << getOperatorSymbol(choice) << " " << num2
+            cout << "\nResult of " << info.name << ":\n";
+            cout << num1 << " " << info.symbol << " " << num2
                  << " = " << result << "\n" << endl;
             cout << resetiosflags(ios::fixed);
         } catch (const runtime_error& e) {
             cout << "\nError: " << e.what() << "\n" << endl;
         }
     }
+};
+
+// Reads "name=value" arguments into the values for an expression's variables
+vector<double> bindVariables(const CompiledExpression& expression, int argc, char* argv[], int first) {
+    const vector<string>& names = expression.getVariables();
+    vector<double> values(names.size(), 0.0);
+    vector<bool> bound(names.size(), false);
+    for (int i = first; i < argc; i++) {
+        const char* equals = strchr(argv[i], '=');
+        if (!equals)
+            throw runtime_error(string("Expected name=value, got '") + argv[i] + "'.");
+        string name(argv[i], equals - argv[i]);
+        for (size_t slot = 0; slot < names.size(); slot++) {
+            if (names[slot] == name) {
+                values[slot] = strtod(equals + 1, nullptr);
+                bound[slot] = true;
+            }
+        }
+    }
+    for (size_t slot = 0; slot < names.size(); slot++)
+        if (!bound[slot])
+            throw runtime_error("No value given for '" + names[slot] + "'.");
+    return values;
+}
+
+// Compiles an expression once and times evaluating it over many rows of inputs
+void benchmarkExpression(const string& text, size_t rows) {
+    auto start = chrono::steady_clock::now();
+    FastExpression expression(text);
+    double compileSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t width = max<size_t>(1, expression.getBytecode().getVariables().size());
+    vector<double> inputs(rows * width);
+    for (size_t i = 0; i < inputs.size(); i++)
+        inputs[i] = 1.0 + static_cast<double>(i % 1000) * 0.5;
 
+    double checksum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t row = 0; row < rows; row++)
+        checksum += expression.evaluate(&inputs[row * width]);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Compiled in " << compileSeconds * 1e6 << " us to " << expression.getBytecode().getInstructionCount()
+         << " instructions, " << (expression.isNative() ? "run as native code" : "interpreted") << "\n"
+         << rows << " evaluations in " << seconds << "s (" << seconds * 1e9 / rows
+         << " ns each, checksum " << checksum << ")\n";
+}
+
+// Times the per-element virtual execute against the batch API for every
+// operation, and checks that both give the same answers. The data is a
+// cache-sized block processed repeatedly, so the numbers show compute cost
+// rather than memory bandwidth.
+void benchmarkBatch(size_t count) {
+    const size_t block = 4096;
+    size_t rounds = max<size_t>(1, count / block);
+    mt19937_64 random(42);
+    uniform_int_distribution<int> wholeNumbers(-1000, 1000);
+    vector<double> a(block), b(block), perElement(block), batch(block);
+    vector<LaneError> errors(block);
+    for (size_t i = 0; i < block; i++) {
+        a[i] = wholeNumbers(random);
+        b[i] = wholeNumbers(random); // Includes a few zeros to exercise the error lanes
+    }
+
+    for (const Operation* operation : BINARY_OPERATIONS) {
+        size_t scalarFailures = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t round = 0; round < rounds; round++) {
+            for (size_t i = 0; i < block; i++) {
+                try {
+                    perElement[i] = operation->execute(a[i], b[i]);
+                } catch (const runtime_error&) {
+                    perElement[i] = numeric_limits<double>::quiet_NaN();
+                    scalarFailures++;
+                }
+            }
+        }
+        double scalarSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        size_t batchFailures = 0;
+        start = chrono::steady_clock::now();
+        for (size_t round = 0; round < rounds; round++)
+            batchFailures += operation->execute(a.data(), b.data(), batch.data(), errors.data(), block);
+        double batchSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < block; i++)
+            if (perElement[i] != batch[i] && !(isnan(perElement[i]) && isnan(batch[i])))
+                mismatches++;
+
+        double elements = double(rounds) * block;
+        cout << left << setw(15) << operation->getName() << right << fixed << setprecision(3)
+             << " per element " << setw(7) << scalarSeconds * 1e9 / elements << " ns"
+             << "   batch " << setw(7) << batchSeconds * 1e9 / elements << " ns"
+             << "   speedup " << setw(6) << setprecision(1) << scalarSeconds / max(batchSeconds, 1e-12) << "x"
+             << "   failed " << batchFailures << "/" << scalarFailures
+             << (mismatches ? "   MISMATCHES: " + to_string(mismatches) : string()) << "\n"
+             << resetiosflags(ios::fixed);
+    }
+#ifdef CALCULATOR_X86_SIMD
+    cout << "(kernels: " << (cpuHasAvx2() ? "AVX2" : "SSE2") << ")\n";
+#endif
+}
+
+// Compares the old heap-allocated, virtual operation path with the
+// variant-based one on a stream of randomly chosen calculations
+void benchmarkDispatch(size_t count) {
+    struct Request {
+        int choice;
+        double a, b;
+    };
+    mt19937_64 random(7);
+    uniform_int_distribution<int> choices(1, OPERATION_COUNT), numbers(1, 1000);
+    vector<Request> requests(4096);
+    for (Request& request : requests)
+        request = {choices(random), double(numbers(random)), double(numbers(random))};
+    size_t rounds = max<size_t>(1, count / requests.size());
+    double calculations = double(rounds) * requests.size();
+
+    // What Calculator used to do: delete and new an operation every time
+    double virtualSum = 0;
+    auto start = chrono::steady_clock::now();
+    Operation* heapOperation = nullptr;
+    for (size_t round = 0; round < rounds; round++) {
+        for (const Request& request : requests) {
+            delete heapOperation;
+            switch (request.choice) {
+                case 1: heapOperation = new Addition(); break;
+                case 2: heapOperation = new Subtraction(); break;
+                case 3: heapOperation = new Multiplication(); break;
+                case 4: heapOperation = new Division(); break;
+                default: heapOperation = new Modulus(); break;
+            }
+            virtualSum += heapOperation->execute(request.a, request.b);
+        }
+    }
+    delete heapOperation;
+    double virtualSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double variantSum = 0;
+    start = chrono::steady_clock::now();
+    AnyOperation operation;
+    for (size_t round = 0; round < rounds; round++) {
+        for (const Request& request : requests) {
+            operation = makeOperation(request.choice);
+            variantSum += applyOperation(operation, request.a, request.b);
+        }
+    }
+    double variantSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(2)
+         << "new/delete + virtual call: " << virtualSeconds * 1e9 / calculations << " ns per calculation\n"
+         << "variant + direct call:     " << variantSeconds * 1e9 / calculations << " ns per calculation ("
+         << virtualSeconds / max(variantSeconds, 1e-12) << "x faster)\n"
+         << resetiosflags(ios::fixed)
+         << (virtualSum == variantSum ? "Results match.\n" : "RESULTS DIFFER!\n");
+}
+
+// Builds a random whole number with exactly the given number of digits
+BigInt randomBigInt(size_t digits, mt19937_64& random) {
+    string text(max<size_t>(1, digits), '0');
+    for (char& digit : text)
+        digit = static_cast<char>('0' + random() % 10);
+    text[0] = static_cast<char>('1' + random() % 9);
+    return BigInt::parse(text);
+}
+
+// Times exact arithmetic on big operands and checks the results agree
+void benchmarkBigInt(size_t digits) {
+    mt19937_64 random(11);
+    BigInt a = randomBigInt(digits, random);
+    BigInt b = randomBigInt(max<size_t>(1, digits / 2), random);
+
+    auto timeIt = [](const string& name, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        auto result = body();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "  " << left << setw(28) << name << right << fixed << setprecision(3)
+             << setw(10) << seconds * 1e3 << " ms\n" << resetiosflags(ios::fixed);
+        return result;
+    };
+
+    cout << digits << "-digit a, " << max<size_t>(1, digits / 2) << "-digit b\n";
+    BigInt product = timeIt("a * b", [&] { return MULTIPLICATION.execute(a, b); });
+    BigInt square = timeIt("a * a", [&] { return MULTIPLICATION.execute(a, a); });
+    BigInt quotient = timeIt("(a * b) / b", [&] { return DIVISION.execute(product, b); });
+    BigInt remainder = timeIt("(a * a) % b", [&] { return MODULUS.execute(square, b); });
+    BigInt sum = timeIt("a + b", [&] { return ADDITION.execute(a, b); });
+    string text = timeIt("to decimal (a * a)", [&] { return square.toString(); });
+    BigInt reparsed = timeIt("from decimal (a * a)", [&] { return BigInt::parse(text); });
+
+    bool ok = quotient == a && reparsed == square && SUBTRACTION.execute(sum, b) == a &&
+              remainder == square - (square / b) * b;
+    cout << (ok ? "All results check out.\n" : "RESULTS DO NOT CHECK OUT!\n");
+}
+
+#ifdef __linux__
+// Applies one operation to every row of a big input file. The input is
+// memory-mapped and cut into chunks; each thread parses its chunk, runs
+// the batch kernel on it and formats the results, and the chunks are then
+// written out in order before the next set starts, so memory use stays at
+// a few chunks per thread however large the file is.
+//   CSV input:    one "a,b" pair per line; output has one result per line
+//                 (or "error: <reason>")
+//   Binary input: ".bin" files of packed native-endian double pairs;
+//                 output is packed doubles, NaN where a row failed
+class BulkCalculator {
 private:
-    // Show the right symbol for the operation
-    string getOperatorSymbol(int choice) const {
-        switch (choice) {
-            case 1: return "+";
-            case 2: return "-";
-            case 3: return "*";
-            case 4: return "/";
-            case 5: return "%";
-            default: return "";
+    // Everything one thread needs for a chunk, reused from chunk to chunk
+    struct ChunkWork {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        vector<double> a, b, results;
+        vector<LaneError> errors;
+        vector<uint8_t> unreadable; // Rows whose text was not two numbers
+        string output;
+        size_t rows = 0;
+    };
+
+    const Operation& operation;
+    int threadCount;
+    size_t chunkBytes;
+
+    static bool isBinaryFile(const string& path) {
+        return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    }
+
+    static const char* skipBlanks(const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        return p;
+    }
+
+    // Splits one chunk of CSV text into operand arrays
+    static void parseCsv(ChunkWork& work) {
+        work.a.clear();
+        work.b.clear();
+        work.unreadable.clear();
+        // Lines are rarely shorter than 8 bytes, so this usually avoids regrowing
+        size_t expectedRows = (work.end - work.begin) / 8 + 1;
+        work.a.reserve(expectedRows);
+        work.b.reserve(expectedRows);
+        work.unreadable.reserve(expectedRows);
+        const char* p = work.begin;
+        while (p < work.end) {
+            const char* lineEnd = static_cast<const char*>(memchr(p, '\n', work.end - p));
+            if (!lineEnd) lineEnd = work.end;
+            const char* contentEnd = (lineEnd > p && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+
+            if (contentEnd > p) { // Blank lines are skipped
+                double a = 0, b = 0;
+                const char* q = skipBlanks(p, contentEnd);
+                auto first = from_chars(q, contentEnd, a);
+                q = skipBlanks(first.ptr, contentEnd);
+                bool ok = first.ec == errc() && q < contentEnd && *q == ',';
+                if (ok) {
+                    q = skipBlanks(q + 1, contentEnd);
+                    auto second = from_chars(q, contentEnd, b);
+                    ok = second.ec == errc() && skipBlanks(second.ptr, contentEnd) == contentEnd;
+                }
+                work.a.push_back(a);
+                work.b.push_back(b);
+                work.unreadable.push_back(ok ? 0 : 1);
+            }
+            p = lineEnd + 1;
+        }
+        work.rows = work.a.size();
+    }
+
+    // Parses, calculates and formats one CSV chunk
+    void processCsv(ChunkWork& work) const {
+        parseCsv(work);
+        work.results.resize(work.rows);
+        work.errors.resize(work.rows);
+        operation.execute(work.a.data(), work.b.data(), work.results.data(), work.errors.data(), work.rows);
+
+        // Numbers are formatted straight into one buffer sized for the worst
+        // case; whole results skip the (slower) shortest-float formatting
+        const size_t longestLine = 64;
+        work.output.resize(work.rows * longestLine);
+        char* p = &work.output[0];
+        for (size_t i = 0; i < work.rows; i++) {
+            const char* message = nullptr;
+            if (work.unreadable[i])
+                message = "expected two numbers separated by a comma";
+            else if (work.errors[i] != LaneError::None)
+                message = describeLaneError(work.errors[i]);
+
+            if (message) {
+                p += snprintf(p, longestLine, "error: %s", message);
+            } else {
+                double result = work.results[i];
+                if (fabs(result) < 9e15 && result == static_cast<double>(static_cast<long long>(result)))
+                    p = to_chars(p, p + 32, static_cast<long long>(result)).ptr;
+                else
+                    p = to_chars(p, p + 32, result).ptr;
+            }
+            *p++ = '\n';
         }
+        work.output.resize(p - work.output.data());
+    }
+
+    // Calculates one chunk of packed (a, b) double pairs
+    void processBinary(ChunkWork& work) const {
+        work.rows = (work.end - work.begin) / (2 * sizeof(double));
+        work.a.resize(work.rows);
+        work.b.resize(work.rows);
+        work.results.resize(work.rows);
+        for (size_t i = 0; i < work.rows; i++) {
+            memcpy(&work.a[i], work.begin + i * 2 * sizeof(double), sizeof(double));
+            memcpy(&work.b[i], work.begin + i * 2 * sizeof(double) + sizeof(double), sizeof(double));
+        }
+        // Failed rows come back as NaN, which is all the binary output records
+        operation.execute(work.a.data(), work.b.data(), work.results.data(), nullptr, work.rows);
+        work.output.assign(reinterpret_cast<const char*>(work.results.data()), work.rows * sizeof(double));
+    }
+
+public:
+    BulkCalculator(const Operation& operation, int threads, size_t chunkBytes = 8 << 20)
+        : operation(operation), threadCount(max(1, threads)), chunkBytes(chunkBytes) {}
+
+    // Processes the whole input file; returns false (with a message) on I/O errors
+    bool run(const string& inputPath, const string& outputPath) {
+        int fd = open(inputPath.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) < 0) {
+            cout << "Could not open " << inputPath << ": " << strerror(errno) << "\n";
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        const char* data = nullptr;
+        if (size > 0) {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                cout << "Could not map " << inputPath << ": " << strerror(errno) << "\n";
+                close(fd);
+                return false;
+            }
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+        close(fd);
+
+        FILE* out = fopen(outputPath.c_str(), "wb");
+        if (!out) {
+            cout << "Could not create " << outputPath << ": " << strerror(errno) << "\n";
+            if (data) munmap(const_cast<char*>(data), size);
+            return false;
+        }
+        setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+        bool binary = isBinaryFile(inputPath);
+        size_t recordBytes = 2 * sizeof(double);
+        size_t step = binary ? max(recordBytes, chunkBytes / recordBytes * recordBytes) : chunkBytes;
+        size_t usable = binary ? size / recordBytes * recordBytes : size;
+
+        // Where a chunk starting near offset really starts: CSV chunks begin
+        // just after a newline so no line is split between two threads
+        auto chunkStart = [&](size_t offset) -> size_t {
+            if (offset >= usable) return usable;
+            if (binary || offset == 0) return offset;
+            const char* newline = static_cast<const char*>(memchr(data + offset - 1, '\n', usable - offset + 1));
+            return newline ? static_cast<size_t>(newline - data) + 1 : usable;
+        };
+
+        // Rounds of one chunk per thread, run by threads that live for the
+        // whole file. Rounds alternate between two sets of chunks, so this
+        // thread writes out one round while the workers do the next.
+        size_t roundBytes = step * threadCount;
+        size_t roundCount = (usable + roundBytes - 1) / roundBytes;
+        vector<ChunkWork> work(2 * threadCount);
+        mutex lock;
+        condition_variable roundStarted, roundDone;
+        size_t started = 0;  // Rounds handed to the workers
+        int busy = 0;        // Workers still on the latest round
+        bool stopping = false;
+
+        auto startRound = [&](size_t round) {
+            size_t offset = round * roundBytes;
+            for (int t = 0; t < threadCount; t++) {
+                ChunkWork& chunk = work[(round % 2) * threadCount + t];
+                chunk.begin = data + chunkStart(offset + t * step);
+                chunk.end = data + chunkStart(offset + (t + 1) * step);
+            }
+            lock_guard<mutex> guard(lock);
+            started = round + 1;
+            busy = threadCount;
+            roundStarted.notify_all();
+        };
+
+        vector<thread> workers;
+        for (int t = 0; t < threadCount; t++)
+            workers.emplace_back([&, t] {
+                for (size_t round = 0;; round++) {
+                    {
+                        unique_lock<mutex> guard(lock);
+                        roundStarted.wait(guard, [&] { return started > round || stopping; });
+                        if (started <= round) return;
+                    }
+                    ChunkWork& chunk = work[(round % 2) * threadCount + t];
+                    if (binary) processBinary(chunk);
+                    else processCsv(chunk);
+                    lock_guard<mutex> guard(lock);
+                    if (--busy == 0) roundDone.notify_one();
+                }
+            });
+        auto stopWorkers = [&] {
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+            }
+            roundStarted.notify_all();
+            for (thread& worker : workers)
+                worker.join();
+        };
+
+        size_t rows = 0, failed = 0;
+        auto start = chrono::steady_clock::now();
+        if (roundCount > 0) startRound(0);
+        for (size_t round = 0; round < roundCount; round++) {
+            {
+                unique_lock<mutex> guard(lock);
+                roundDone.wait(guard, [&] { return busy == 0; });
+            }
+            if (round + 1 < roundCount) startRound(round + 1);
+
+            for (int t = 0; t < threadCount; t++) {
+                ChunkWork& chunk = work[(round % 2) * threadCount + t];
+                if (fwrite(chunk.output.data(), 1, chunk.output.size(), out) != chunk.output.size()) {
+                    cout << "Could not write " << outputPath << ": " << strerror(errno) << "\n";
+                    stopWorkers();
+                    fclose(out);
+                    munmap(const_cast<char*>(data), size);
+                    return false;
+                }
+                rows += chunk.rows;
+                for (size_t i = 0; i < chunk.rows; i++)
+                    failed += binary ? isnan(chunk.results[i]) : (chunk.unreadable[i] || chunk.errors[i] != LaneError::None);
+                chunk.rows = 0;
+                chunk.output.clear();
+            }
+        }
+        stopWorkers();
+        bool closed = fclose(out) == 0;
+        if (data) munmap(const_cast<char*>(data), size);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << operation.getName() << " of " << rows << " row(s), " << failed << " failed, in "
+             << seconds << "s (" << (seconds > 0 ? rows / seconds / 1e6 : 0.0) << "M rows/sec, "
+             << (seconds > 0 ? size / seconds / (1 << 20) : 0.0) << " MB/sec) on " << threadCount << " thread(s)\n";
+        return closed;
     }
 };
 
+// Writes a test input of random operand pairs, CSV or binary by extension
+bool writeSampleInput(const string& path, size_t rows) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) {
+        cout << "Could not create " << path << ": " << strerror(errno) << "\n";
+        return false;
+    }
+    setvbuf(out, nullptr, _IOFBF, 1 << 20);
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    mt19937_64 random(3);
+    uniform_int_distribution<int> numbers(-100000, 100000);
+    char line[64];
+    for (size_t i = 0; i < rows; i++) {
+        double pair[2] = {numbers(random) / 4.0, double(numbers(random) / 1000)};
+        if (binary) {
+            fwrite(pair, sizeof(double), 2, out);
+        } else {
+            int length = snprintf(line, sizeof(line), "%.17g,%.17g\n", pair[0], pair[1]);
+            fwrite(line, 1, length, out);
+        }
+    }
+    return fclose(out) == 0;
+}
+#endif
+
+void printUsage(const char* program) {
+    cout << "Usage:\n"
+         << "  " << program << "                                  interactive calculator\n"
+         << "  " << program << " --eval <expression> [name=value ...]   evaluate an expression\n"
+         << "  " << program << " --bytecode <expression>               show the compiled bytecode\n"
+         << "  " << program << " --bench-expr <expression> [rows]      time repeated evaluation\n"
+         << "  " << program << " --bench-batch [count]                 time batch against per-element operations\n"
+         << "  " << program << " --bench-dispatch [count]              time virtual against variant dispatch\n"
+         << "  " << program << " --exact <a> <+ - * / %> <b>          exact whole-number calculation\n"
+         << "  " << program << " --bench-bigint [digits]               time exact arithmetic on huge numbers\n"
+#ifdef __linux__
+         << "  " << program << " --batch <+ - * / %> <input> <output> [threads]\n"
+         << "        apply an operation to every row of a CSV (or packed .bin) file\n"
+         << "  " << program << " --make-input <file> <rows>            write random rows for --batch\n"
+#endif
+#if defined(__linux__) && defined(__x86_64__)
+         << "  " << program << " --jit <expression> [rows]             compare native code with the interpreter\n"
+#endif
+         ;
+}
+
+// Handles the non-interactive modes; returns the process exit code
+int runCommand(int argc, char* argv[]) {
+    string mode = argv[1];
+    if (mode == "--bench-batch") {
+        benchmarkBatch(argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000);
+        return 0;
+    }
+    if (mode == "--bench-dispatch") {
+        benchmarkDispatch(argc > 2 ? strtoull(argv[2], nullptr, 10) : 50000000);
+        return 0;
+    }
+    if (mode == "--bench-bigint") {
+        benchmarkBigInt(argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000);
+        return 0;
+    }
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+#ifdef __linux__
+        if (mode == "--batch" && argc >= 5) {
+            int choice = 0;
+            for (int i = 0; i < OPERATION_COUNT; i++)
+                if (strlen(argv[2]) == 1 && OPERATION_INFO[i].symbol == argv[2][0])
+                    choice = i + 1;
+            if (choice == 0)
+                throw runtime_error(string("Unknown operator '") + argv[2] + "'.");
+            int threads = argc > 5 ? atoi(argv[5]) : static_cast<int>(thread::hardware_concurrency());
+            BulkCalculator bulk(*BINARY_OPERATIONS[choice - 1], threads);
+            return bulk.run(argv[3], argv[4]) ? 0 : 1;
+        }
+        if (mode == "--make-input" && argc == 4) {
+            return writeSampleInput(argv[2], strtoull(argv[3], nullptr, 10)) ? 0 : 1;
+        }
+#endif
+#if defined(__linux__) && defined(__x86_64__)
+        if (mode == "--jit") {
+            benchmarkJit(argv[2], argc > 3 ? strtoull(argv[3], nullptr, 10) : 10000000);
+            return 0;
+        }
+#endif
+        if (mode == "--exact" && argc == 5) {
+            int choice = 0;
+            for (int i = 0; i < OPERATION_COUNT; i++)
+                if (strlen(argv[3]) == 1 && OPERATION_INFO[i].symbol == argv[3][0])
+                    choice = i + 1;
+            if (choice == 0)
+                throw runtime_error(string("Unknown operator '") + argv[3] + "'.");
+            BigInt a = BigInt::parse(argv[2]), b = BigInt::parse(argv[4]);
+            cout << applyOperation(makeOperation(choice), a, b).toString() << "\n";
+            return 0;
+        }
+        if (mode == "--eval") {
+            FastExpression expression(argv[2]);
+            cout << expression.evaluate(bindVariables(expression.getBytecode(), argc, argv, 3)) << "\n";
+            return 0;
+        }
+        if (mode == "--bytecode") {
+            cout << ExpressionParser().compile(argv[2]).disassemble();
+            return 0;
+        }
+        if (mode == "--bench-expr") {
+            benchmarkExpression(argv[2], argc > 3 ? strtoull(argv[3], nullptr, 10) : 10000000);
+            return 0;
+        }
+    } catch (const runtime_error& e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
+
 // This is where the program starts
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        return runCommand(argc, argv);
+
     cout << "Welcome to the Calculator\n";
 
     Calculator calc;
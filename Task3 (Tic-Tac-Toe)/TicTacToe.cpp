@@ -1,6 +1,32 @@
 #include <iostream>
+#include <iomanip>
 #include <limits>
 #include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <array>
+#include <sstream>
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
 using namespace std;
 
 // This class handles user input and makes sure the input is valid (1 to 9).
@@ -23,6 +49,624 @@ public:
             }
         }
     }
+
+    // Reads a "row column" pair (both from 1) and returns the cell index
+    int getCell(const string& prompt, int rows, int columns) {
+        int row, column;
+        while (true) {
+            cout << prompt;
+            cin >> row >> column;
+
+            if (cin.fail() || row < 1 || row > rows || column < 1 || column > columns) {
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Please enter a row (1-" << rows << ") and a column (1-" << columns << ").\n";
+            } else {
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                return (row - 1) * columns + (column - 1);
+            }
+        }
+    }
+};
+
+// Rows, columns and both diagonals of the 3x3 board, as masks of cells
+// (bit i is cell i + 1)
+constexpr uint16_t WIN_LINES[8] = {
+    0x007, 0x038, 0x1C0, // Rows 1-2-3, 4-5-6, 7-8-9
+    0x049, 0x092, 0x124, // Columns 1-4-7, 2-5-8, 3-6-9
+    0x111, 0x054,        // Diagonals 1-5-9, 3-5-7
+};
+
+// One bit for each of the 512 possible masks of a player's marks, set when
+// the mask contains a winning line. Worked out from WIN_LINES at compile time.
+struct WinTable {
+    uint64_t bits[8];
+};
+
+constexpr WinTable buildWinTable() {
+    WinTable table{};
+    for (int mask = 0; mask < 512; mask++)
+        for (uint16_t line : WIN_LINES)
+            if ((mask & line) == line)
+                table.bits[mask >> 6] |= 1ULL << (mask & 63);
+    return table;
+}
+
+constexpr WinTable WINNING_MASKS = buildWinTable();
+
+constexpr bool containsWinningLine(uint16_t mask) {
+    return WINNING_MASKS.bits[mask >> 6] >> (mask & 63) & 1;
+}
+
+// Every position has a code in base 3: cell i contributes 3^i times
+// 0 (empty), 1 (X) or 2 (O)
+constexpr int POSITION_CODES = 19683; // 3^9
+
+// Base-3 value of each 9-bit mask with its set cells counted as 1, so a
+// position's code is MASK_CODES[x] + 2 * MASK_CODES[o]
+struct MaskCodeTable {
+    uint16_t values[512];
+};
+
+constexpr MaskCodeTable buildMaskCodeTable() {
+    MaskCodeTable table{};
+    for (int mask = 0; mask < 512; mask++) {
+        int code = 0;
+        for (int cell = 8; cell >= 0; cell--)
+            code = code * 3 + (mask >> cell & 1);
+        table.values[mask] = static_cast<uint16_t>(code);
+    }
+    return table;
+}
+
+constexpr MaskCodeTable MASK_CODES = buildMaskCodeTable();
+
+constexpr int positionCode(uint16_t x, uint16_t o) {
+    return MASK_CODES.values[x] + 2 * MASK_CODES.values[o];
+}
+
+// The 8 symmetries of the board (rotations and reflections). Cell i of the
+// transformed board is cell SYMMETRIES[s][i] of the original.
+constexpr int SYMMETRIES[8][9] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8}, // Identity
+    {6, 3, 0, 7, 4, 1, 8, 5, 2}, // Rotate 90 degrees clockwise
+    {8, 7, 6, 5, 4, 3, 2, 1, 0}, // Rotate 180 degrees
+    {2, 5, 8, 1, 4, 7, 0, 3, 6}, // Rotate 270 degrees clockwise
+    {2, 1, 0, 5, 4, 3, 8, 7, 6}, // Mirror left-right
+    {6, 7, 8, 3, 4, 5, 0, 1, 2}, // Mirror top-bottom
+    {0, 3, 6, 1, 4, 7, 2, 5, 8}, // Main diagonal
+    {8, 5, 2, 7, 4, 1, 6, 3, 0}, // Anti-diagonal
+};
+
+// Every 9-bit mask under each symmetry, so transforming a board is a lookup
+struct SymmetryTable {
+    uint16_t masks[8][512];
+};
+
+constexpr SymmetryTable buildSymmetryTable() {
+    SymmetryTable table{};
+    for (int symmetry = 0; symmetry < 8; symmetry++)
+        for (int mask = 0; mask < 512; mask++) {
+            int transformed = 0;
+            for (int cell = 0; cell < 9; cell++)
+                transformed |= (mask >> SYMMETRIES[symmetry][cell] & 1) << cell;
+            table.masks[symmetry][mask] = static_cast<uint16_t>(transformed);
+        }
+    return table;
+}
+
+constexpr SymmetryTable SYMMETRIC_MASKS = buildSymmetryTable();
+
+// The smallest code among the 8 symmetric versions of a position, shared by
+// all of them
+inline int canonicalCode(uint16_t x, uint16_t o) {
+    int best = positionCode(x, o);
+    for (int symmetry = 1; symmetry < 8; symmetry++) {
+        int code = positionCode(SYMMETRIC_MASKS.masks[symmetry][x], SYMMETRIC_MASKS.masks[symmetry][o]);
+        if (code < best) best = code;
+    }
+    return best;
+}
+
+// Center first, then corners, then edges: the strong moves come early,
+// so alpha-beta cuts off sooner
+constexpr int MOVE_ORDER[9] = {4, 0, 2, 6, 8, 1, 3, 5, 7};
+
+// Scores are from the side to move: 0 for a draw, and a win or loss is
+// worth 1 plus the number of empty cells left, so quicker wins and slower
+// losses score better
+constexpr int8_t UNSOLVED = -128;
+
+// Score and best cell (0-8, or -1 when the game is over) for every position
+// reachable from the empty board, indexed by position code
+struct SolvedTable {
+    int8_t score[POSITION_CODES];
+    int8_t move[POSITION_CODES];
+};
+
+// Plain negamax, remembering each position so it is only solved once
+constexpr int solvePosition(SolvedTable& table, uint16_t x, uint16_t o, int empty) {
+    int code = positionCode(x, o);
+    if (table.score[code] != UNSOLVED) return table.score[code];
+
+    bool xToMove = empty % 2 == 1;
+    uint16_t mover = xToMove ? x : o;
+    uint16_t other = xToMove ? o : x;
+    int best = 0, bestMove = -1;
+    if (containsWinningLine(other)) {
+        best = -(1 + empty);
+    } else if (empty > 0) {
+        best = -127;
+        for (int cell : MOVE_ORDER) {
+            if ((mover | other) >> cell & 1) continue;
+            uint16_t moved = static_cast<uint16_t>(mover | 1 << cell);
+            int score = -solvePosition(table, xToMove ? moved : x, xToMove ? o : moved, empty - 1);
+            if (score > best) {
+                best = score;
+                bestMove = cell;
+            }
+        }
+    }
+    table.score[code] = static_cast<int8_t>(best);
+    table.move[code] = static_cast<int8_t>(bestMove);
+    return best;
+}
+
+constexpr SolvedTable buildSolvedTable() {
+    SolvedTable table{};
+    for (int code = 0; code < POSITION_CODES; code++) {
+        table.score[code] = UNSOLVED;
+        table.move[code] = -1;
+    }
+    solvePosition(table, 0, 0, 9);
+    return table;
+}
+
+// The whole game, solved while compiling
+constexpr SolvedTable SOLVED = buildSolvedTable();
+static_assert(SOLVED.score[0] == 0, "Tic-Tac-Toe is a draw with perfect play");
+
+// The 3x3 board as two 9-bit masks, one per player; bit i is cell i + 1.
+// A win is one table lookup on the player's mask and a draw is a full
+// board, so neither check has to look at individual cells.
+class BitBoard {
+public:
+    static constexpr uint16_t FULL = 0x1FF;
+
+private:
+    uint16_t marks[2] = {0, 0}; // [0] for X, [1] for O
+
+public:
+    // Player index used by the masks: 0 for 'X', 1 for 'O'
+    static int indexOf(char player) { return player == 'X' ? 0 : 1; }
+
+    static bool containsLine(uint16_t mask) { return containsWinningLine(mask); }
+
+    void clear() { marks[0] = marks[1] = 0; }
+    uint16_t getMarks(int player) const { return marks[player]; }
+    uint16_t occupied() const { return marks[0] | marks[1]; }
+
+    // cell is 0-8
+    bool isEmpty(int cell) const { return !(occupied() >> cell & 1); }
+    void place(int cell, int player) { marks[player] |= uint16_t(1u << cell); }
+    void remove(int cell, int player) { marks[player] &= uint16_t(~(1u << cell)); }
+
+    bool hasWon(int player) const { return containsLine(marks[player]); }
+    // Number of marks on the board
+    int moveCount() const { return __builtin_popcount(occupied()); }
+    // All 9 bits set; same as moveCount() == 9 without needing a popcount instruction
+    bool isFull() const { return occupied() == FULL; }
+    // Index into the solved table
+    int code() const { return positionCode(marks[0], marks[1]); }
+
+    // 'X', 'O', or the cell's number when it is still free
+    char symbolAt(int cell) const {
+        if (marks[0] >> cell & 1) return 'X';
+        if (marks[1] >> cell & 1) return 'O';
+        return static_cast<char>('1' + cell);
+    }
+};
+
+// An m x n board where k in a row wins; 3x3 with k = 3 is ordinary
+// Tic-Tac-Toe. Cells are numbered row * columns + column and players are
+// 0 (X) and 1 (O), as on BitBoard. A move only checks the four lines through
+// itself, and the free cells are kept in a set, so making or undoing a move
+// costs the same on a 15x15 board as on a 3x3 one.
+class MNKBoard {
+private:
+    int rows, columns, k;
+    vector<int8_t> cells;   // 0 when empty, otherwise player + 1
+    vector<int> emptyCells; // Free cells, in no particular order
+    vector<int> emptySlot;  // Where each free cell sits in emptyCells
+    vector<int> history;    // Moves made, oldest first
+    int winner;             // -1 until a move completes k in a row
+
+    // Marks of player in a row from cell, stepping (rowStep, columnStep), not counting cell
+    int countFrom(int cell, int player, int rowStep, int columnStep) const {
+        int row = cell / columns + rowStep, column = cell % columns + columnStep;
+        int count = 0;
+        while (count < k - 1 && row >= 0 && row < rows && column >= 0 && column < columns &&
+               cells[row * columns + column] == player + 1) {
+            count++;
+            row += rowStep;
+            column += columnStep;
+        }
+        return count;
+    }
+
+    // Whether the mark just placed at cell makes k in a row
+    bool completesLine(int cell, int player) const {
+        static const int STEPS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+        for (const auto& step : STEPS)
+            if (1 + countFrom(cell, player, step[0], step[1]) + countFrom(cell, player, -step[0], -step[1]) >= k)
+                return true;
+        return false;
+    }
+
+public:
+    MNKBoard(int rows, int columns, int k)
+        : rows(rows), columns(columns), k(k), cells(rows * columns, 0),
+          emptyCells(rows * columns), emptySlot(rows * columns), winner(-1) {
+        for (int cell = 0; cell < rows * columns; cell++)
+            emptyCells[cell] = emptySlot[cell] = cell;
+        history.reserve(rows * columns);
+    }
+
+    // Copies keep room for a whole game, so playing on a copy never allocates
+    MNKBoard(const MNKBoard& other)
+        : rows(other.rows), columns(other.columns), k(other.k), cells(other.cells),
+          emptyCells(other.emptyCells), emptySlot(other.emptySlot), history(other.history),
+          winner(other.winner) {
+        emptyCells.reserve(cellCount());
+        history.reserve(cellCount());
+    }
+    MNKBoard& operator=(const MNKBoard&) = default;
+
+    int getRows() const { return rows; }
+    int getColumns() const { return columns; }
+    int getK() const { return k; }
+    int cellCount() const { return rows * columns; }
+
+    bool isEmpty(int cell) const { return cells[cell] == 0; }
+    const vector<int>& getEmptyCells() const { return emptyCells; }
+    const vector<int>& getHistory() const { return history; }
+    int moveCount() const { return static_cast<int>(history.size()); }
+    // Player 0 (X) moves first
+    int playerToMove() const { return moveCount() % 2; }
+
+    int getWinner() const { return winner; }
+    bool isFull() const { return emptyCells.empty(); }
+    bool isOver() const { return winner >= 0 || isFull(); }
+
+    // Puts player's mark on a free cell; returns true if that wins
+    bool place(int cell, int player) {
+        cells[cell] = static_cast<int8_t>(player + 1);
+        int last = emptyCells.back();
+        emptyCells[emptySlot[cell]] = last;
+        emptySlot[last] = emptySlot[cell];
+        emptyCells.pop_back();
+        history.push_back(cell);
+        if (completesLine(cell, player)) winner = player;
+        return winner == player;
+    }
+
+    // Takes back the most recent move
+    void undo() {
+        int cell = history.back();
+        history.pop_back();
+        cells[cell] = 0;
+        emptySlot[cell] = static_cast<int>(emptyCells.size());
+        emptyCells.push_back(cell);
+        winner = -1;
+    }
+
+    // Back to an empty board, in time proportional to the moves made
+    void clear() {
+        while (!history.empty()) undo();
+    }
+
+    // 'X', 'O' or '.' for a free cell
+    char symbolAt(int cell) const { return ".XO"[cells[cell]]; }
+};
+
+// Perfect play straight from the compile-time table: no search at all
+class PerfectPlayer {
+public:
+    // Best cell (0-8) for whoever is to move, or -1 when the game is over
+    static int chooseMove(const BitBoard& board) { return SOLVED.move[board.code()]; }
+    static int score(const BitBoard& board) { return SOLVED.score[board.code()]; }
+};
+
+// Negamax with alpha-beta pruning and a transposition table. Positions are
+// stored under their canonical code, so all 8 symmetric versions of a
+// position share one entry. It gives the same answers as the solved table
+// and is what --solve checks that table against.
+class AlphaBetaSolver {
+private:
+    enum Bound : int8_t { EXACT, LOWER, UPPER };
+
+    struct Entry {
+        int8_t score;
+        int8_t bound;
+        bool stored;
+    };
+
+    vector<Entry> table;     // Indexed by canonical code
+    size_t storedPositions;  // Entries in use
+    size_t nodes;            // Positions visited
+
+    // mover and other are the marks of the side to move and of its opponent
+    int negamax(uint16_t mover, uint16_t other, int empty, int alpha, int beta) {
+        nodes++;
+        if (containsWinningLine(other)) return -(1 + empty);
+        if (empty == 0) return 0;
+
+        bool xToMove = empty % 2 == 1;
+        Entry& entry = table[xToMove ? canonicalCode(mover, other) : canonicalCode(other, mover)];
+        if (entry.stored) {
+            if (entry.bound == EXACT) return entry.score;
+            if (entry.bound == LOWER) alpha = max(alpha, int(entry.score));
+            else beta = min(beta, int(entry.score));
+            if (alpha >= beta) return entry.score;
+        }
+
+        int originalAlpha = alpha;
+        int best = -127;
+        for (int cell : MOVE_ORDER) {
+            if ((mover | other) >> cell & 1) continue;
+            int score = -negamax(other, static_cast<uint16_t>(mover | 1 << cell), empty - 1, -beta, -alpha);
+            best = max(best, score);
+            alpha = max(alpha, score);
+            if (alpha >= beta) break;
+        }
+
+        if (!entry.stored) storedPositions++;
+        entry.stored = true;
+        entry.score = static_cast<int8_t>(best);
+        entry.bound = best <= originalAlpha ? UPPER : best >= beta ? LOWER : EXACT;
+        return best;
+    }
+
+    static void split(const BitBoard& board, uint16_t& mover, uint16_t& other, int& empty) {
+        empty = 9 - board.moveCount();
+        bool xToMove = empty % 2 == 1;
+        mover = board.getMarks(xToMove ? 0 : 1);
+        other = board.getMarks(xToMove ? 1 : 0);
+    }
+
+public:
+    AlphaBetaSolver() : table(POSITION_CODES, Entry{0, EXACT, false}), storedPositions(0), nodes(0) {}
+
+    // Exact score of the position for the side to move
+    int score(const BitBoard& board) {
+        uint16_t mover, other;
+        int empty;
+        split(board, mover, other, empty);
+        return negamax(mover, other, empty, -127, 127);
+    }
+
+    // Best cell (0-8) for the side to move, or -1 when the game is over
+    int chooseMove(const BitBoard& board) {
+        uint16_t mover, other;
+        int empty;
+        split(board, mover, other, empty);
+        if (empty == 0 || containsWinningLine(other)) return -1;
+
+        int best = -127, bestMove = -1;
+        for (int cell : MOVE_ORDER) {
+            if ((mover | other) >> cell & 1) continue;
+            int score = -negamax(other, static_cast<uint16_t>(mover | 1 << cell), empty - 1, -127, -best);
+            if (score > best) {
+                best = score;
+                bestMove = cell;
+            }
+        }
+        return bestMove;
+    }
+
+    size_t getStoredPositions() const { return storedPositions; }
+    size_t getNodes() const { return nodes; }
+};
+
+// Small, fast generator (SplitMix64) for rollouts; each thread owns one
+class FastRandom {
+private:
+    uint64_t state;
+
+public:
+    explicit FastRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound), using a multiply and shift instead of a division
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>((next() >> 32) * bound >> 32); }
+};
+
+// Monte Carlo Tree Search for MNKBoard positions too big to search
+// exhaustively. All threads work on one shared tree. Visit and score counts
+// are atomics, and a thread counts its visit on the way down (a "virtual
+// loss"), so other threads steer away from that line until its result is in.
+// Nodes come from a pool allocated once, and each thread plays rollouts on
+// its own copy of the board with its own generator, so a search allocates
+// nothing once its threads are running.
+class MCTSPlayer {
+public:
+    struct Result {
+        int move;        // Chosen cell
+        size_t playouts; // Rollouts played
+        size_t nodes;    // Tree nodes used
+        double seconds;  // Wall time of the search
+    };
+
+private:
+    static constexpr int32_t LEAF = -1;      // firstChild before expansion
+    static constexpr int32_t EXPANDING = -2; // firstChild while a thread expands the node
+    static constexpr size_t BATCH = 64;      // Playouts claimed at a time, between checks of the clock
+    static constexpr int32_t EXPAND_AFTER = 32; // Visits before a leaf gets children
+
+    struct Node {
+        atomic<int32_t> visits{0};
+        atomic<int64_t> score{0};          // 2 per win and 1 per draw for the player who moved here
+        atomic<int32_t> firstChild{LEAF};  // Children sit next to each other in the pool
+        int32_t childCount = 0;
+        int32_t move = -1;                 // Cell played to reach this node
+    };
+
+    int threads;
+    size_t maxNodes;
+    uint64_t seed;
+    double exploration;
+    unique_ptr<Node[]> nodes;
+    atomic<size_t> nodesUsed;
+    size_t searches;
+
+    // Gives node a child for every free cell; false if another thread got
+    // there first or the pool is full
+    bool expand(Node& node, const MNKBoard& board) {
+        int32_t expected = LEAF;
+        if (!node.firstChild.compare_exchange_strong(expected, EXPANDING, memory_order_acquire))
+            return false;
+        const vector<int>& free = board.getEmptyCells();
+        // Reserve the children only if they fit, so nodesUsed never passes maxNodes
+        size_t first = nodesUsed.load(memory_order_relaxed);
+        do {
+            if (first + free.size() > maxNodes) {
+                node.firstChild.store(LEAF, memory_order_relaxed);
+                return false;
+            }
+        } while (!nodesUsed.compare_exchange_weak(first, first + free.size(), memory_order_relaxed));
+        for (size_t i = 0; i < free.size(); i++) nodes[first + i].move = free[i];
+        node.childCount = static_cast<int32_t>(free.size());
+        node.firstChild.store(static_cast<int32_t>(first), memory_order_release);
+        return true;
+    }
+
+    // Child with the best UCT value; unvisited children come first
+    int32_t selectChild(const Node& node, int32_t first) const {
+        double logVisits = log(double(max(1, node.visits.load(memory_order_relaxed))));
+        int32_t best = first;
+        double bestValue = -1;
+        for (int32_t child = first; child < first + node.childCount; child++) {
+            int32_t visits = nodes[child].visits.load(memory_order_relaxed);
+            if (visits == 0) return child;
+            double value = nodes[child].score.load(memory_order_relaxed) / (2.0 * visits) +
+                           exploration * sqrt(logVisits / visits);
+            if (value > bestValue) {
+                bestValue = value;
+                best = child;
+            }
+        }
+        return best;
+    }
+
+    // One selection, expansion, rollout and backup, leaving board as it was
+    void playout(MNKBoard& board, FastRandom& random, vector<int32_t>& path) {
+        int rootMoves = board.moveCount();
+        path.clear();
+        path.push_back(0);
+        nodes[0].visits.fetch_add(1, memory_order_relaxed);
+
+        int32_t current = 0;
+        while (!board.isOver()) {
+            Node& node = nodes[current];
+            int32_t first = node.firstChild.load(memory_order_acquire);
+            // Leaves only get rollouts until they have been visited a few times, so
+            // wide boards do not spend the pool on children that are never tried
+            if (first == LEAF && node.visits.load(memory_order_relaxed) > EXPAND_AFTER && expand(node, board))
+                first = node.firstChild.load(memory_order_acquire);
+            if (first < 0) break;
+
+            current = selectChild(node, first);
+            nodes[current].visits.fetch_add(1, memory_order_relaxed);
+            board.place(nodes[current].move, board.playerToMove());
+            path.push_back(current);
+        }
+
+        while (!board.isOver()) {
+            const vector<int>& free = board.getEmptyCells();
+            board.place(free[random.below(static_cast<uint32_t>(free.size()))], board.playerToMove());
+        }
+
+        // path[i] was reached by a move of player (rootMoves + i - 1) % 2
+        int winner = board.getWinner();
+        for (size_t i = 0; i < path.size(); i++) {
+            int mover = static_cast<int>((rootMoves + i + 1) % 2);
+            int64_t points = winner < 0 ? 1 : winner == mover ? 2 : 0;
+            if (points) nodes[path[i]].score.fetch_add(points, memory_order_relaxed);
+        }
+
+        while (board.moveCount() > rootMoves) board.undo();
+    }
+
+public:
+    // threads 0 means one per core; maxNodes bounds the tree's memory
+    MCTSPlayer(int threads = 0, size_t maxNodes = 1 << 21, uint64_t seed = 1)
+        : threads(threads > 0 ? threads : max(1u, thread::hardware_concurrency())),
+          maxNodes(maxNodes), seed(seed), exploration(1.4), nodes(new Node[maxNodes]),
+          nodesUsed(0), searches(0) {}
+
+    int getThreads() const { return threads; }
+
+    // Searches until seconds have passed or maxPlayouts are done (0 means no
+    // limit) and returns the most visited move
+    Result search(const MNKBoard& root, double seconds, size_t maxPlayouts = 0) {
+        // Only the nodes the last search used need clearing
+        for (size_t i = 0; i < nodesUsed.load(); i++) {
+            nodes[i].visits.store(0, memory_order_relaxed);
+            nodes[i].score.store(0, memory_order_relaxed);
+            nodes[i].firstChild.store(LEAF, memory_order_relaxed);
+            nodes[i].childCount = 0;
+        }
+        nodesUsed.store(1);
+        searches++;
+
+        atomic<size_t> playouts(0); // Claimed by the threads, never more than limit
+        atomic<bool> stop(false);
+        size_t limit = maxPlayouts ? maxPlayouts : SIZE_MAX;
+        auto start = chrono::steady_clock::now();
+        auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+
+        auto work = [&](int index) {
+            MNKBoard board = root;
+            FastRandom random(seed ^ (searches * 0x9E3779B97F4A7C15ULL) ^ (uint64_t(index + 1) << 32));
+            vector<int32_t> path;
+            path.reserve(board.cellCount() + 1);
+            while (!stop.load(memory_order_relaxed)) {
+                // The last batch is cut to what is left of the budget
+                size_t claimed = playouts.load(memory_order_relaxed), batch;
+                do {
+                    batch = min(BATCH, limit - claimed);
+                } while (batch && !playouts.compare_exchange_weak(claimed, claimed + batch, memory_order_relaxed));
+                if (!batch) break;
+                for (size_t i = 0; i < batch; i++) playout(board, random, path);
+                if (chrono::steady_clock::now() >= deadline) stop.store(true, memory_order_relaxed);
+            }
+        };
+
+        vector<thread> workers;
+        for (int i = 1; i < threads; i++) workers.emplace_back(work, i);
+        work(0);
+        for (thread& worker : workers) worker.join();
+
+        Result result;
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.playouts = playouts.load();
+        result.nodes = nodesUsed.load();
+        result.move = root.isOver() ? -1 : root.getEmptyCells()[0];
+        int32_t first = nodes[0].firstChild.load();
+        int32_t mostVisits = -1;
+        for (int32_t child = max(first, 0); first >= 0 && child < first + nodes[0].childCount; child++)
+            if (nodes[child].visits.load() > mostVisits) {
+                mostVisits = nodes[child].visits.load();
+                result.move = nodes[child].move;
+            }
+        return result;
+    }
 };
 
 // Base class for any game (currently just Tic-Tac-Toe)
@@ -37,16 +681,14 @@ public:
 // The main Tic-Tac-Toe game class
 class TicTacToe : public BaseGame {
 private:
-    char board[3][3];        // 3x3 grid
+    BitBoard board;          // 3x3 grid as one bit mask per player
     char currentPlayer;      // 'X' or 'O'
+    char computerPlayer;     // Side played by the computer, or 0 for two humans
     bool gameEnded;          // True when the game ends
 
-    // Initializes the board with numbers 1 to 9
+    // Clears the board (empty cells show their numbers 1 to 9)
     void resetBoard() {
-        int num = 1;
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                board[i][j] = '0' + num++;
+        board.clear();
         currentPlayer = 'X';
         gameEnded = false;
     }
@@ -55,7 +697,8 @@ private:
     void showBoard() const {
         cout << "\n";
         for (int i = 0; i < 3; ++i) {
-            cout << " " << board[i][0] << " | " << board[i][1] << " | " << board[i][2] << "\n";
+            cout << " " << board.symbolAt(3 * i) << " | " << board.symbolAt(3 * i + 1) << " | "
+                 << board.symbolAt(3 * i + 2) << "\n";
             if (i < 2) cout << "---+---+---\n";
         }
         cout << "\n";
@@ -73,7 +716,7 @@ private:
     bool isMoveValid(int move) const {
         int row, col;
         if (!getMoveCoordinates(move, row, col)) return false;
-        return board[row][col] != 'X' && board[row][col] != 'O';
+        return board.isEmpty(move - 1);
     }
 
     // Updates the board with the current player's move
@@ -84,36 +727,18 @@ private:
             cout << "That spot’s already taken or invalid. Try again!\n";
             return false;
         }
-        board[row][col] = currentPlayer;
+        board.place(move - 1, BitBoard::indexOf(currentPlayer));
         return true;
     }
 
     // Checks for winning conditions
     bool checkWin() const {
-        for (int i = 0; i < 3; ++i)
-            if (board[i][0] == currentPlayer && board[i][1] == currentPlayer && board[i][2] == currentPlayer)
-                return true;
-
-        for (int j = 0; j < 3; ++j)
-            if (board[0][j] == currentPlayer && board[1][j] == currentPlayer && board[2][j] == currentPlayer)
-                return true;
-
-        if (board[0][0] == currentPlayer && board[1][1] == currentPlayer && board[2][2] == currentPlayer)
-            return true;
-
-        if (board[0][2] == currentPlayer && board[1][1] == currentPlayer && board[2][0] == currentPlayer)
-            return true;
-
-        return false;
+        return board.hasWon(BitBoard::indexOf(currentPlayer));
     }
 
     // Checks if the board is completely filled (draw)
     bool checkDraw() const {
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                if (board[i][j] != 'X' && board[i][j] != 'O')
-                    return false;
-        return true;
+        return board.isFull();
     }
 
     // Switches turn between players
@@ -123,25 +748,36 @@ private:
 
     // Displays the outcome of the game
     virtual void showResult() const {
-        if (checkWin())
+        if (checkWin() && currentPlayer == computerPlayer)
+            cout << "The computer wins! Better luck next time.\n";
+        else if (checkWin())
             cout << "Player " << currentPlayer << " wins! Great game!\n";
         else if (checkDraw())
             cout << "It’s a tie! Well played, both of you!\n";
     }
 
 public:
-    TicTacToe() {
+    // computer is 'X' or 'O' to play against the perfect player, or 0 for two humans
+    explicit TicTacToe(char computer = 0) : computerPlayer(computer) {
         resetBoard(); // Start fresh
     }
 
     // Main game loop
     void play() override {
         while (!gameEnded) {
-            string prompt = "Player " + string(1, currentPlayer) + ", enter your move (1-9): ";
-            int move = validator.getMove(prompt);
+            int move;
+            if (currentPlayer == computerPlayer) {
+                move = PerfectPlayer::chooseMove(board) + 1;
+            } else {
+                string prompt = "Player " + string(1, currentPlayer) + ", enter your move (1-9): ";
+                move = validator.getMove(prompt);
+            }
 
             if (makeMove(move)) {
-                cout << "Nice move!\n";
+                if (currentPlayer == computerPlayer)
+                    cout << "Computer plays " << move << ".\n";
+                else
+                    cout << "Nice move!\n";
                 showBoard();
 
                 if (checkWin() || checkDraw()) {
@@ -158,8 +794,1248 @@ public:
     }
 };
 
-int main() {
-    cout << "Welcome to Tic-Tac-Toe! Player 1 is X, Player 2 is O.\n";
+// Two players on an m x n board, k in a row to win; either side can be
+// played by the MCTS engine
+class MNKGame : public BaseGame {
+private:
+    MNKBoard board;
+    char currentPlayer;    // 'X' or 'O'
+    char computerPlayer;   // Side played by the computer, or 0 for two humans
+    double secondsPerMove; // Computer's thinking time
+    unique_ptr<MCTSPlayer> engine;
+
+    void showBoard() const {
+        cout << "\n    ";
+        for (int column = 1; column <= board.getColumns(); column++) cout << setw(3) << column;
+        cout << "\n";
+        for (int row = 0; row < board.getRows(); row++) {
+            cout << setw(4) << row + 1;
+            for (int column = 0; column < board.getColumns(); column++)
+                cout << "  " << board.symbolAt(row * board.getColumns() + column);
+            cout << "\n";
+        }
+        cout << "\n";
+    }
+
+public:
+    MNKGame(int rows, int columns, int k, char computer = 0, double secondsPerMove = 1.0)
+        : board(rows, columns, k), currentPlayer('X'), computerPlayer(computer),
+          secondsPerMove(secondsPerMove) {
+        if (computer) engine.reset(new MCTSPlayer());
+    }
+
+    void play() override {
+        showBoard();
+        while (!board.isOver()) {
+            int cell;
+            if (currentPlayer == computerPlayer) {
+                MCTSPlayer::Result result = engine->search(board, secondsPerMove);
+                cell = result.move;
+                cout << "Computer plays " << cell / board.getColumns() + 1 << " " << cell % board.getColumns() + 1
+                     << " after " << result.playouts << " playouts ("
+                     << static_cast<long long>(result.playouts / max(result.seconds, 1e-9)) << "/s).\n";
+            } else {
+                string prompt = "Player " + string(1, currentPlayer) + ", enter row and column: ";
+                cell = validator.getCell(prompt, board.getRows(), board.getColumns());
+            }
+            if (!board.isEmpty(cell)) {
+                cout << "That spot’s already taken. Try again!\n";
+                continue;
+            }
+            board.place(cell, BitBoard::indexOf(currentPlayer));
+            showBoard();
+            if (!board.isOver()) currentPlayer = (currentPlayer == 'X') ? 'O' : 'X';
+        }
+
+        if (board.getWinner() >= 0)
+            cout << "Player " << currentPlayer << " gets " << board.getK() << " in a row and wins!\n";
+        else
+            cout << "It’s a tie! Well played, both of you!\n";
+    }
+};
+
+// Recorded games file: a 12-byte header ("TTTGAMES", then rows, columns, k
+// and a version byte) followed by one record per game. A record is a varint
+// of (moves << 2 | result), result 0 for an X win, 1 for a draw and 2 for
+// an O win, then the moves. On boards of up to MAX_RANKED_CELLS cells each
+// move is stored as its rank among the free cells, and the ranks are packed
+// into one mixed-radix varint: a whole 3x3 game is at most 19 bits, so a
+// record is 3-4 bytes. Bigger boards use one varint cell number per move.
+const char* const GAMES_MAGIC = "TTTGAMES";
+const size_t GAMES_HEADER_BYTES = 12;
+const int MAX_RANKED_CELLS = 20; // 20! still fits in 64 bits
+
+void writeVarint(vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Reads a varint and moves p past it; false if it runs off the end
+bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Decodes the record at p on a board of cells cells; false if it is damaged,
+// or torn off by the end of the file, which leaves p at end
+bool decodeGameRecord(const uint8_t*& p, const uint8_t* end, int cells, int& result, int* moves, int& count) {
+    uint64_t header;
+    if (!readVarint(p, end, header)) return false;
+    count = static_cast<int>(min<uint64_t>(header >> 2, INT32_MAX));
+    result = static_cast<int>(header & 3);
+    if (count > cells || result > 2) return false;
+
+    uint64_t value;
+    if (cells > MAX_RANKED_CELLS) {
+        for (int i = 0; i < count; i++) {
+            if (!readVarint(p, end, value) || value >= uint64_t(cells)) return false;
+            moves[i] = static_cast<int>(value);
+        }
+        return true;
+    }
+    if (!readVarint(p, end, value)) return false;
+    uint32_t free = (1u << cells) - 1;
+    for (int i = 0; i < count; i++) {
+        int rank = static_cast<int>(value % uint64_t(cells - i));
+        value /= uint64_t(cells - i);
+        // The rank-th free cell
+        uint32_t rest = free;
+        for (int skip = 0; skip < rank; skip++) rest &= rest - 1;
+        moves[i] = __builtin_ctz(rest);
+        free &= ~(1u << moves[i]);
+    }
+    return true;
+}
+
+// Appends finished games to a recorded games file through a large buffer
+class GameRecordWriter {
+private:
+    FILE* file = nullptr;
+    int cellCount = 0;
+    mutex lock; // Tournament threads share one writer
+    vector<char> buffer;
+
+    // Length of the file up to the end of its last whole record, read a
+    // block at a time from the start of the records; false if a record is
+    // damaged rather than just cut short by a crash
+    bool completeLength(uint64_t& length) {
+        const size_t longest = 10 * size_t(cellCount) + 10; // Varints are at most 10 bytes
+        vector<uint8_t> block((1 << 20) + longest);
+        vector<int> moves(cellCount);
+        length = GAMES_HEADER_BYTES;
+        size_t held = 0;
+        bool atEnd = false;
+        fseek(file, static_cast<long>(GAMES_HEADER_BYTES), SEEK_SET);
+        while (true) {
+            if (!atEnd) {
+                size_t got = fread(block.data() + held, 1, block.size() - held, file);
+                held += got;
+                atEnd = held < block.size();
+            }
+            const uint8_t* p = block.data();
+            const uint8_t* end = p + held;
+            int result, count;
+            // Away from the end of the file, a record always fits in what is held
+            while (p < end && (atEnd || size_t(end - p) >= longest)) {
+                const uint8_t* start = p;
+                if (!decodeGameRecord(p, end, cellCount, result, moves.data(), count)) {
+                    fseek(file, 0, SEEK_END);
+                    return atEnd && p == end; // Torn off by a crash: length stops before it
+                }
+                length += uint64_t(p - start);
+            }
+            if (atEnd && p == end) break;
+            held = size_t(end - p);
+            memmove(block.data(), p, held);
+        }
+        fseek(file, 0, SEEK_END);
+        return true;
+    }
+
+public:
+    GameRecordWriter() = default;
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    ~GameRecordWriter() { close(); }
+
+    // Opens path for appending, writing the header if it is new and cutting
+    // off a record torn by a crash; false if the file cannot be used, is
+    // damaged or was recorded on a different board
+    bool open(const string& path, int rows, int columns, int k) {
+        close();
+        file = fopen(path.c_str(), "ab+");
+        if (!file) return false;
+        buffer.resize(1 << 20);
+        setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+        const uint8_t header[GAMES_HEADER_BYTES] = {
+            'T', 'T', 'T', 'G', 'A', 'M', 'E', 'S',
+            uint8_t(rows), uint8_t(columns), uint8_t(k), 1};
+        uint8_t existing[GAMES_HEADER_BYTES];
+        fseek(file, 0, SEEK_SET);
+        size_t got = fread(existing, 1, GAMES_HEADER_BYTES, file);
+        fseek(file, 0, SEEK_END);
+        cellCount = rows * columns;
+        if (got == 0) {
+            fwrite(header, 1, GAMES_HEADER_BYTES, file);
+        } else if (got != GAMES_HEADER_BYTES || memcmp(existing, header, GAMES_HEADER_BYTES) != 0) {
+            close();
+            return false;
+        } else {
+            // A crash can leave half a record at the end; new games start
+            // where the last whole one ends
+            uint64_t length;
+            if (!completeLength(length)) {
+                close();
+                return false;
+            }
+            if (uint64_t(ftell(file)) > length) {
+                fflush(file);
+#ifdef _WIN32
+                bool cut = _chsize_s(_fileno(file), static_cast<long long>(length)) == 0;
+#else
+                bool cut = ftruncate(fileno(file), static_cast<off_t>(length)) == 0;
+#endif
+                if (!cut) {
+                    close();
+                    return false;
+                }
+                fseek(file, 0, SEEK_END);
+            }
+        }
+        return true;
+    }
+
+    // False if the last games could not be written out
+    bool close() {
+        bool ok = !file || fclose(file) == 0;
+        file = nullptr;
+        return ok;
+    }
+
+    // Appends the record for a finished game on board to out
+    static void encode(const MNKBoard& board, vector<uint8_t>& out) {
+        const vector<int>& moves = board.getHistory();
+        int winner = board.getWinner();
+        writeVarint(out, uint64_t(moves.size()) << 2 | (winner < 0 ? 1 : winner == 0 ? 0 : 2));
+
+        int cells = board.cellCount();
+        if (cells > MAX_RANKED_CELLS) {
+            for (int move : moves) writeVarint(out, static_cast<uint64_t>(move));
+            return;
+        }
+        uint32_t free = (1u << cells) - 1;
+        uint64_t code = 0, scale = 1;
+        for (size_t i = 0; i < moves.size(); i++) {
+            code += scale * __builtin_popcount(free & ((1u << moves[i]) - 1));
+            scale *= cells - i;
+            free &= ~(1u << moves[i]);
+        }
+        writeVarint(out, code);
+    }
+
+    // Writes encoded records; safe to call from several threads
+    bool append(const vector<uint8_t>& records) {
+        lock_guard<mutex> guard(lock);
+        return fwrite(records.data(), 1, records.size(), file) == records.size();
+    }
+};
+
+#ifdef __linux__
+// Read-only view of a recorded games file through a memory map. Opening
+// it finds where every record starts; buildPositionIndex() then lists, for
+// each 3x3 position up to symmetry, the games that reach it (a CSR layout:
+// one offset per canonical code into a single array of game numbers).
+//
+// Both are saved next to the games in <file>.idx and mapped by later
+// opens, so only the first query after games are recorded scans the file.
+// The index file is a header (IndexHeader below) followed by the record
+// offsets (u64 each) and, once built, the position starts (u64 each, one
+// per canonical code plus one) and the game numbers (u32 each). When games
+// were recorded since, only the records after the indexed ones are read and
+// added to it; it is rebuilt if its last record no longer ends where it
+// says, or the games file got shorter.
+class GameRecordFile {
+public:
+    struct Game {
+        int result;        // 0 X won, 1 draw, 2 O won
+        vector<int> moves; // Cells in the order played
+    };
+
+private:
+    struct IndexHeader {
+        char magic[8];             // "TTTINDEX"
+        uint32_t version;
+        uint32_t hasPositions;     // 1 if the position index follows the offsets
+        uint64_t gamesBytes;       // End of the last record indexed
+        uint64_t gameCount;
+        uint64_t positionGameCount;
+    };
+
+    int fd = -1;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t tornBytes = 0;              // Part of a record after the last whole one
+    int rows = 0, columns = 0, k = 0;
+    string indexPath;
+    const char* index = nullptr;       // The mapped index file, if it was usable
+    size_t indexSize = 0;
+    size_t indexedBytes = 0;           // End of the last record in the index file
+    bool fromIndex = false;            // The offsets of the first indexedGames games
+    size_t indexedGames = 0;           // came from the index file
+
+    // Point into the index file, or into the vectors below when the
+    // file's index had to be built on this open
+    size_t games = 0;
+    const uint64_t* recordStarts = nullptr;     // Byte offset of each game
+    const uint64_t* positionStarts = nullptr;   // Per canonical code, into positionGames; one extra at the end
+    const uint32_t* positionGames = nullptr;    // Game numbers grouped by canonical code
+    vector<uint64_t> builtStarts;
+    vector<uint64_t> builtPositionStarts;
+    vector<uint32_t> builtPositionGames;
+
+    // Maps indexPath if it was made from the games file as it is now or
+    // from an earlier, shorter copy of it; its last record must still end
+    // where the index says
+    bool mapIndex() {
+        int indexFd = ::open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (indexFd < 0) return false;
+        struct stat info;
+        bool ok = fstat(indexFd, &info) == 0 && size_t(info.st_size) >= sizeof(IndexHeader);
+        void* mapped = ok ? mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, indexFd, 0) : MAP_FAILED;
+        ::close(indexFd);
+        if (mapped == MAP_FAILED) return false;
+
+        const IndexHeader& header = *static_cast<const IndexHeader*>(mapped);
+        size_t expected = sizeof(IndexHeader) + header.gameCount * sizeof(uint64_t);
+        if (header.hasPositions)
+            expected += (POSITION_CODES + 1) * sizeof(uint64_t) + header.positionGameCount * sizeof(uint32_t);
+        if (memcmp(header.magic, "TTTINDEX", 8) != 0 || header.version != 2 || header.gamesBytes > size ||
+            header.gamesBytes < GAMES_HEADER_BYTES || header.gameCount > size ||
+            header.positionGameCount > size * 10 || expected != size_t(info.st_size)) {
+            munmap(mapped, size_t(info.st_size));
+            return false;
+        }
+        index = static_cast<const char*>(mapped);
+        indexSize = size_t(info.st_size);
+        games = header.gameCount;
+        indexedBytes = header.gamesBytes;
+        recordStarts = reinterpret_cast<const uint64_t*>(index + sizeof(IndexHeader));
+        if (header.hasPositions) {
+            positionStarts = recordStarts + games;
+            positionGames = reinterpret_cast<const uint32_t*>(positionStarts + POSITION_CODES + 1);
+        }
+
+        // The last indexed record has to decode and end at gamesBytes
+        bool matches = games ? recordStarts[games - 1] < indexedBytes : indexedBytes == GAMES_HEADER_BYTES;
+        if (matches && games) {
+            const uint8_t* p = data + recordStarts[games - 1];
+            vector<int> moves(rows * columns);
+            int result, count;
+            matches = decodeAt(p, result, moves.data(), count) && p == data + indexedBytes;
+        }
+        if (!matches || (positionStarts && positionStarts[POSITION_CODES] != header.positionGameCount)) {
+            unmapIndex();
+            return false;
+        }
+        return true;
+    }
+
+    void unmapIndex() {
+        if (index) munmap(const_cast<char*>(index), indexSize);
+        index = nullptr;
+        indexSize = games = indexedBytes = 0;
+        recordStarts = positionStarts = nullptr;
+        positionGames = nullptr;
+    }
+
+    // Saves the offsets, and the position index if built, to indexPath
+    // through a temporary file and a rename; a failure only costs a rescan
+    // next time
+    void saveIndex() const {
+        IndexHeader header{};
+        memcpy(header.magic, "TTTINDEX", 8);
+        header.version = 2;
+        header.hasPositions = positionStarts ? 1 : 0;
+        header.gamesBytes = size - tornBytes;
+        header.gameCount = games;
+        header.positionGameCount = positionStarts ? positionStarts[POSITION_CODES] : 0;
+
+        string temporary = indexPath + ".tmp";
+        FILE* file = fopen(temporary.c_str(), "wb");
+        if (!file) return;
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(recordStarts, sizeof(uint64_t), games, file) == games;
+        if (ok && positionStarts)
+            ok = fwrite(positionStarts, sizeof(uint64_t), POSITION_CODES + 1, file) == POSITION_CODES + 1 &&
+                 fwrite(positionGames, sizeof(uint32_t), header.positionGameCount, file) == header.positionGameCount;
+        ok = fclose(file) == 0 && ok;
+        if (!ok || rename(temporary.c_str(), indexPath.c_str()) != 0) remove(temporary.c_str());
+    }
+
+    // Decodes the record at p; false if it is damaged or torn
+    bool decodeAt(const uint8_t*& p, int& result, int* moves, int& count) const {
+        return decodeGameRecord(p, data + size, rows * columns, result, moves, count);
+    }
+
+public:
+    GameRecordFile() = default;
+    GameRecordFile(const GameRecordFile&) = delete;
+    GameRecordFile& operator=(const GameRecordFile&) = delete;
+
+    ~GameRecordFile() { close(); }
+
+    // Maps the file and finds every record, from the index file when that is
+    // up to date; false if it is missing or damaged
+    bool open(const string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) < 0 || size_t(info.st_size) < GAMES_HEADER_BYTES) {
+            close();
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close();
+            return false;
+        }
+        data = static_cast<const uint8_t*>(mapped);
+        if (memcmp(data, GAMES_MAGIC, 8) != 0 || data[11] != 1) {
+            close();
+            return false;
+        }
+        rows = data[8];
+        columns = data[9];
+        k = data[10];
+        indexPath = path + ".idx";
+        fromIndex = mapIndex();
+        indexedGames = games;
+        if (fromIndex && indexedBytes == size) return true;
+
+        // Read the records the index does not have yet, or all of them
+        const uint8_t* p = data + (fromIndex ? indexedBytes : GAMES_HEADER_BYTES);
+        if (!fromIndex) madvise(mapped, size, MADV_SEQUENTIAL);
+        if (fromIndex) builtStarts.assign(recordStarts, recordStarts + games);
+        vector<int> moves(rows * columns);
+        int result, count;
+        while (p < data + size) {
+            const uint8_t* start = p;
+            if (!decodeAt(p, result, moves.data(), count)) {
+                if (p != data + size) {
+                    close();
+                    return false;
+                }
+                // Cut short by a crash while recording; the recorder drops it
+                tornBytes = size_t(p - start);
+                break;
+            }
+            builtStarts.push_back(uint64_t(start - data));
+        }
+        if (fromIndex && builtStarts.size() == indexedGames) {
+            // Only part of a torn record follows; the index is still current
+            builtStarts.clear();
+            return true;
+        }
+        games = builtStarts.size();
+        recordStarts = builtStarts.data();
+        if (positionStarts) {
+            // Add the new games to the position index the file already had
+            const uint64_t* oldStarts = positionStarts;
+            const uint32_t* oldGames = positionGames;
+            indexPositions(indexedGames, oldStarts, oldGames);
+        }
+        saveIndex();
+        if (index) munmap(const_cast<char*>(index), indexSize);
+        index = nullptr;
+        indexSize = 0;
+        return true;
+    }
+
+    void close() {
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+        unmapIndex();
+        if (fd >= 0) ::close(fd);
+        data = nullptr;
+        size = tornBytes = indexedGames = 0;
+        fromIndex = false;
+        fd = -1;
+        builtStarts.clear();
+        builtPositionStarts.clear();
+        builtPositionGames.clear();
+    }
+
+    int getRows() const { return rows; }
+    int getColumns() const { return columns; }
+    int getK() const { return k; }
+    size_t gameCount() const { return games; }
+    size_t byteCount() const { return size; }
+    size_t tornByteCount() const { return tornBytes; }
+
+    // True if the record offsets came from the index file; newGameCount()
+    // of them were recorded after it was saved and had to be read
+    bool indexWasSaved() const { return fromIndex; }
+    size_t newGameCount() const { return fromIndex ? games - indexedGames : games; }
+
+    Game game(size_t index) const {
+        const uint8_t* p = data + recordStarts[index];
+        Game game;
+        game.moves.resize(rows * columns);
+        int count;
+        decodeAt(p, game.result, game.moves.data(), count);
+        game.moves.resize(count);
+        return game;
+    }
+
+    // Result of a game without decoding its moves
+    int result(size_t index) const {
+        const uint8_t* p = data + recordStarts[index];
+        uint64_t header;
+        readVarint(p, data + size, header);
+        return static_cast<int>(header & 3);
+    }
+
+    // Counts, then fills, the games reaching each canonical 3x3 position,
+    // the empty board included, unless the index file already has them.
+    // Only 3x3 files can be indexed.
+    bool buildPositionIndex() {
+        if (rows != 3 || columns != 3) return false;
+        if (positionStarts) return true;
+        indexPositions(0, nullptr, nullptr);
+        saveIndex();
+        return true;
+    }
+
+    // Games that reach the position with marks x and o, or any of its
+    // rotations and reflections, in the order they were recorded
+    pair<const uint32_t*, const uint32_t*> gamesReaching(uint16_t x, uint16_t o) const {
+        int code = canonicalCode(x, o);
+        return {positionGames + positionStarts[code], positionGames + positionStarts[code + 1]};
+    }
+
+private:
+    // Builds the position index in the vectors from the games from
+    // firstGame on, placed after the ones in oldStarts/oldGames (the index
+    // of the games before firstGame) when given
+    void indexPositions(size_t firstGame, const uint64_t* oldStarts, const uint32_t* oldGames) {
+        vector<uint64_t>& starts = builtPositionStarts;
+        vector<uint32_t>& gamesAt = builtPositionGames;
+        starts.assign(POSITION_CODES + 1, 0);
+
+        // Canonical code of every position code, so games can be followed by
+        // adding 3^cell per X move and twice that per O move
+        vector<uint16_t> canonical(POSITION_CODES);
+        for (int code = 0; code < POSITION_CODES; code++) {
+            uint16_t marks[2] = {0, 0};
+            for (int cell = 0, rest = code; cell < 9; cell++, rest /= 3)
+                if (rest % 3) marks[rest % 3 - 1] |= uint16_t(1u << cell);
+            canonical[code] = static_cast<uint16_t>(canonicalCode(marks[0], marks[1]));
+        }
+        static const int POWERS_OF_3[9] = {1, 3, 9, 27, 81, 243, 729, 2187, 6561};
+
+        int moves[9], result, count;
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t game = firstGame; game < games; game++) {
+                const uint8_t* p = data + recordStarts[game];
+                decodeAt(p, result, moves, count);
+                int code = 0;
+                for (int i = 0; i <= count; i++) {
+                    int canonicalPosition = canonical[code];
+                    if (pass == 0) starts[canonicalPosition + 1]++;
+                    else gamesAt[starts[canonicalPosition]++] = static_cast<uint32_t>(game);
+                    if (i < count) code += (i % 2 + 1) * POWERS_OF_3[moves[i]];
+                }
+            }
+            if (pass == 0) {
+                for (int code = 0; code < POSITION_CODES; code++) {
+                    if (oldStarts) starts[code + 1] += oldStarts[code + 1] - oldStarts[code];
+                    starts[code + 1] += starts[code];
+                }
+                gamesAt.resize(starts[POSITION_CODES]);
+                // Earlier games go first in each code's list, as they were recorded first
+                if (oldStarts)
+                    for (int code = 0; code < POSITION_CODES; code++) {
+                        copy(oldGames + oldStarts[code], oldGames + oldStarts[code + 1], gamesAt.begin() + starts[code]);
+                        starts[code] += oldStarts[code + 1] - oldStarts[code];
+                    }
+            } else {
+                // The fill pass moved every start to the next code's; shift them back
+                for (int code = POSITION_CODES; code > 0; code--)
+                    starts[code] = starts[code - 1];
+                starts[0] = 0;
+            }
+        }
+        positionStarts = starts.data();
+        positionGames = gamesAt.data();
+    }
+};
+#endif
+
+// A computer player for headless games. Tournaments give every worker
+// thread its own instances, so players need no locking.
+class GamePlayer {
+public:
+    virtual ~GamePlayer() = default;
+    // Cell to play for whoever is to move; the game is not over
+    virtual int chooseMove(const MNKBoard& board) = 0;
+};
+
+// Picks any free cell
+class RandomPlayer : public GamePlayer {
+private:
+    FastRandom random;
+
+public:
+    explicit RandomPlayer(uint64_t seed) : random(seed) {}
+
+    int chooseMove(const MNKBoard& board) override {
+        const vector<int>& free = board.getEmptyCells();
+        return free[random.below(static_cast<uint32_t>(free.size()))];
+    }
+};
+
+// AlphaBetaSolver on 3x3 boards with 3 in a row
+class AlphaBetaPlayer : public GamePlayer {
+private:
+    AlphaBetaSolver solver;
+
+public:
+    int chooseMove(const MNKBoard& board) override {
+        BitBoard bits;
+        for (int cell = 0; cell < 9; cell++)
+            if (!board.isEmpty(cell)) bits.place(cell, BitBoard::indexOf(board.symbolAt(cell)));
+        return solver.chooseMove(bits);
+    }
+};
+
+// Single-threaded MCTS with a fixed number of playouts per move
+class MCTSGamePlayer : public GamePlayer {
+private:
+    MCTSPlayer engine;
+    size_t playouts;
+
+public:
+    MCTSGamePlayer(size_t playouts, uint64_t seed) : engine(1, 1 << 16, seed), playouts(playouts) {}
+
+    int chooseMove(const MNKBoard& board) override { return engine.search(board, 1e9, playouts).move; }
+};
+
+// Which player to build: "random", "alphabeta" or "mcts[:playouts]"
+struct PlayerSpec {
+    string name;
+    size_t playouts; // For MCTS
+
+    unique_ptr<GamePlayer> create(uint64_t seed) const {
+        if (name == "random") return unique_ptr<GamePlayer>(new RandomPlayer(seed));
+        if (name == "alphabeta") return unique_ptr<GamePlayer>(new AlphaBetaPlayer());
+        return unique_ptr<GamePlayer>(new MCTSGamePlayer(playouts, seed));
+    }
+};
+
+// Plays many headless games between every ordered pair of players. The
+// games are handed out as ranges on per-thread deques: a thread splits its
+// range and keeps the first half, and an idle thread steals from the front
+// of another thread's deque, where the biggest ranges are. That keeps all
+// threads busy even though an MCTS game takes far longer than a random one.
+class Tournament {
+public:
+    // Log2 buckets of nanoseconds per move
+    static constexpr int TIME_BUCKETS = 40;
+
+    struct Results {
+        vector<array<size_t, 3>> outcomes;       // Per pairing: X wins, draws, O wins
+        vector<array<size_t, TIME_BUCKETS>> thinkTimes; // Per player
+        size_t games = 0;
+        size_t steals = 0;
+        double seconds = 0;
+        bool recordFailed = false;               // A write to the games file failed
+    };
+
+private:
+    static constexpr size_t GRAIN = 64; // Games played without splitting further
+
+    struct GameRange {
+        uint32_t pairing;
+        size_t begin, end;
+    };
+
+    struct WorkQueue {
+        mutex lock;
+        deque<GameRange> ranges;
+    };
+
+    int rows, columns, k;
+    vector<PlayerSpec> players;
+    int threads;
+
+    static int timeBucket(long long nanoseconds) {
+        int bucket = 0;
+        while (bucket < TIME_BUCKETS - 1 && (1LL << (bucket + 1)) <= nanoseconds) bucket++;
+        return bucket;
+    }
+
+public:
+    Tournament(int rows, int columns, int k, const vector<PlayerSpec>& players, int threads)
+        : rows(rows), columns(columns), k(k), players(players),
+          threads(threads > 0 ? threads : max(1u, thread::hardware_concurrency())) {}
+
+    int pairingCount() const { return static_cast<int>(players.size() * players.size()); }
+
+    // Plays gamesPerPairing games for every pairing, appending each finished
+    // game to records when it is given; stops early if that fails
+    Results run(size_t gamesPerPairing, uint64_t seed, GameRecordWriter* records = nullptr) {
+        vector<WorkQueue> queues(threads);
+        for (int pairing = 0; pairing < pairingCount(); pairing++)
+            queues[pairing % threads].ranges.push_back(GameRange{uint32_t(pairing), 0, gamesPerPairing});
+        atomic<size_t> gamesLeft(gamesPerPairing * pairingCount());
+        atomic<bool> recordFailed(false);
+        vector<Results> perThread(threads);
+
+        auto work = [&](int index) {
+            Results& results = perThread[index];
+            results.outcomes.assign(pairingCount(), array<size_t, 3>{});
+            results.thinkTimes.assign(players.size(), array<size_t, TIME_BUCKETS>{});
+            vector<unique_ptr<GamePlayer>> own;
+            for (size_t i = 0; i < players.size(); i++)
+                own.push_back(players[i].create(seed + uint64_t(index) * 1000003 + i));
+            FastRandom random(seed ^ uint64_t(index + 1) << 40);
+            MNKBoard board(rows, columns, k);
+            vector<uint8_t> encoded; // Records not yet handed to the writer
+
+            while (gamesLeft.load(memory_order_relaxed) > 0 && !recordFailed.load(memory_order_relaxed)) {
+                GameRange range;
+                bool found = false;
+                {
+                    lock_guard<mutex> guard(queues[index].lock);
+                    if (!queues[index].ranges.empty()) {
+                        range = queues[index].ranges.back();
+                        queues[index].ranges.pop_back();
+                        found = true;
+                    }
+                }
+                // Nothing of our own: steal the oldest (largest) range from someone else
+                int first = threads > 1 ? static_cast<int>(random.below(threads - 1)) : 0;
+                for (int attempt = 0; !found && attempt < threads - 1; attempt++) {
+                    int victim = (index + 1 + (first + attempt) % (threads - 1)) % threads;
+                    lock_guard<mutex> guard(queues[victim].lock);
+                    if (!queues[victim].ranges.empty()) {
+                        range = queues[victim].ranges.front();
+                        queues[victim].ranges.pop_front();
+                        found = true;
+                        results.steals++;
+                    }
+                }
+                if (!found) {
+                    this_thread::yield();
+                    continue;
+                }
+
+                // Leave the back half where others can steal it
+                while (range.end - range.begin > GRAIN) {
+                    size_t middle = range.begin + (range.end - range.begin) / 2;
+                    lock_guard<mutex> guard(queues[index].lock);
+                    queues[index].ranges.push_back(GameRange{range.pairing, middle, range.end});
+                    range.end = middle;
+                }
+
+                int playerX = static_cast<int>(range.pairing / players.size());
+                int playerO = static_cast<int>(range.pairing % players.size());
+                for (size_t game = range.begin; game < range.end; game++) {
+                    board.clear();
+                    while (!board.isOver()) {
+                        int mover = board.playerToMove() == 0 ? playerX : playerO;
+                        auto start = chrono::steady_clock::now();
+                        int cell = own[mover]->chooseMove(board);
+                        long long nanoseconds = chrono::duration_cast<chrono::nanoseconds>(
+                            chrono::steady_clock::now() - start).count();
+                        results.thinkTimes[mover][timeBucket(nanoseconds)]++;
+                        board.place(cell, board.playerToMove());
+                    }
+                    int winner = board.getWinner();
+                    results.outcomes[range.pairing][winner == 0 ? 0 : winner == 1 ? 2 : 1]++;
+                    if (records) {
+                        GameRecordWriter::encode(board, encoded);
+                        if (encoded.size() >= (1 << 16)) {
+                            if (!records->append(encoded)) recordFailed = true;
+                            encoded.clear();
+                        }
+                    }
+                }
+                results.games += range.end - range.begin;
+                gamesLeft.fetch_sub(range.end - range.begin, memory_order_relaxed);
+            }
+            if (records && !encoded.empty() && !records->append(encoded)) recordFailed = true;
+        };
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int i = 1; i < threads; i++) workers.emplace_back(work, i);
+        work(0);
+        for (thread& worker : workers) worker.join();
+
+        Results total;
+        total.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        total.recordFailed = recordFailed;
+        total.outcomes.assign(pairingCount(), array<size_t, 3>{});
+        total.thinkTimes.assign(players.size(), array<size_t, TIME_BUCKETS>{});
+        for (const Results& results : perThread) {
+            for (int pairing = 0; pairing < pairingCount(); pairing++)
+                for (int i = 0; i < 3; i++) total.outcomes[pairing][i] += results.outcomes[pairing][i];
+            for (size_t player = 0; player < players.size(); player++)
+                for (int bucket = 0; bucket < TIME_BUCKETS; bucket++)
+                    total.thinkTimes[player][bucket] += results.thinkTimes[player][bucket];
+            total.games += results.games;
+            total.steals += results.steals;
+        }
+        return total;
+    }
+};
+
+// The board as it used to be stored: digit characters for empty cells and
+// a full scan for every check. Kept only so the benchmark can compare.
+struct ScannedBoard {
+    char cells[3][3];
+
+    bool checkWin(char player) const {
+        for (int i = 0; i < 3; ++i)
+            if (cells[i][0] == player && cells[i][1] == player && cells[i][2] == player)
+                return true;
+        for (int j = 0; j < 3; ++j)
+            if (cells[0][j] == player && cells[1][j] == player && cells[2][j] == player)
+                return true;
+        if (cells[0][0] == player && cells[1][1] == player && cells[2][2] == player)
+            return true;
+        return cells[0][2] == player && cells[1][1] == player && cells[2][0] == player;
+    }
+
+    bool checkDraw() const {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                if (cells[i][j] != 'X' && cells[i][j] != 'O')
+                    return false;
+        return true;
+    }
+};
+
+// Times win/draw detection on the old character board against the bitboard
+void benchmarkWinChecks(size_t checks) {
+    // A pool of random positions from random play, in both representations
+    const size_t poolSize = 4096;
+    mt19937 random(1);
+    vector<ScannedBoard> scanned(poolSize);
+    vector<BitBoard> bits(poolSize);
+    vector<char> toCheck(poolSize);
+    for (size_t i = 0; i < poolSize; i++) {
+        for (int cell = 0; cell < 9; cell++)
+            scanned[i].cells[cell / 3][cell % 3] = static_cast<char>('1' + cell);
+        int moves = 1 + random() % 9;
+        for (int move = 0; move < moves; move++) {
+            int cell;
+            do cell = random() % 9; while (!bits[i].isEmpty(cell));
+            char player = move % 2 == 0 ? 'X' : 'O';
+            scanned[i].cells[cell / 3][cell % 3] = player;
+            bits[i].place(cell, BitBoard::indexOf(player));
+            toCheck[i] = player;
+        }
+    }
+
+    size_t rounds = max<size_t>(1, checks / poolSize);
+    double positions = double(rounds) * poolSize;
+    long long scanHits = 0, bitHits = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++)
+        for (size_t i = 0; i < poolSize; i++)
+            scanHits += scanned[i].checkWin(toCheck[i]) * 2 + scanned[i].checkDraw();
+    double scanSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++)
+        for (size_t i = 0; i < poolSize; i++)
+            bitHits += bits[i].hasWon(BitBoard::indexOf(toCheck[i])) * 2 + bits[i].isFull();
+    double bitSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(2)
+         << "Cell scan: " << scanSeconds * 1e9 / positions << " ns per win+draw check\n"
+         << "Bitboard:  " << bitSeconds * 1e9 / positions << " ns per win+draw check ("
+         << scanSeconds / max(bitSeconds, 1e-12) << "x faster)\n"
+         << resetiosflags(ios::fixed)
+         << (scanHits == bitHits ? "Both agree on every position.\n" : "RESULTS DIFFER!\n");
+}
+
+// Checks the alpha-beta solver against the compile-time table on every
+// reachable position, then times move selection with both
+void runSolverCheck() {
+    AlphaBetaSolver solver;
+    auto start = chrono::steady_clock::now();
+    int rootScore = solver.score(BitBoard());
+    double coldSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Empty board scores " << rootScore << " (0 is a draw); searched " << solver.getNodes()
+         << " nodes in " << fixed << setprecision(1) << coldSeconds * 1e6 << " us\n"
+         << resetiosflags(ios::fixed);
+
+    // Every reachable position, decoded from its code
+    vector<BitBoard> positions;
+    for (int code = 0; code < POSITION_CODES; code++) {
+        if (SOLVED.score[code] == UNSOLVED) continue;
+        BitBoard board;
+        for (int cell = 0, rest = code; cell < 9; cell++, rest /= 3)
+            if (rest % 3) board.place(cell, rest % 3 - 1);
+        positions.push_back(board);
+    }
+
+    size_t mismatches = 0;
+    for (const BitBoard& board : positions) {
+        if (solver.score(board) != PerfectPlayer::score(board)) mismatches++;
+        // Any best move is fine, as long as it keeps the score
+        int move = solver.chooseMove(board);
+        if (move >= 0) {
+            BitBoard after = board;
+            after.place(move, (9 - board.moveCount()) % 2 == 1 ? 0 : 1);
+            if (-PerfectPlayer::score(after) != PerfectPlayer::score(board)) mismatches++;
+        }
+    }
+    cout << positions.size() << " reachable positions, " << solver.getStoredPositions()
+         << " unique up to symmetry in the transposition table\n"
+         << (mismatches == 0 ? "Solver and compile-time table agree everywhere.\n" : "SOLVER DISAGREES!\n");
+
+    // Warm timings: the table is full now
+    const int rounds = 20;
+    long long checksum = 0;
+    start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++)
+        for (const BitBoard& board : positions)
+            checksum += solver.chooseMove(board);
+    double searchSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++)
+        for (const BitBoard& board : positions)
+            checksum += PerfectPlayer::chooseMove(board);
+    double lookupSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double moves = double(rounds) * positions.size();
+    cout << fixed << setprecision(1)
+         << "Alpha-beta (warm table): " << searchSeconds * 1e9 / moves << " ns per move\n"
+         << "Compile-time table:      " << lookupSeconds * 1e9 / moves << " ns per move\n"
+         << resetiosflags(ios::fixed);
+
+    // Keeps the timed loops from being optimised away
+    volatile long long sink = checksum;
+    (void)sink;
+}
+
+// Win check by scanning every cell of an m x n board in all four directions,
+// the way larger boards were handled before MNKBoard. Kept for the benchmark.
+bool scanForWin(const MNKBoard& board, int player) {
+    static const int STEPS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    char mark = player == 0 ? 'X' : 'O';
+    int rows = board.getRows(), columns = board.getColumns(), k = board.getK();
+    for (int row = 0; row < rows; row++)
+        for (int column = 0; column < columns; column++)
+            for (const auto& step : STEPS) {
+                int length = 0;
+                int r = row, c = column;
+                while (length < k && r >= 0 && r < rows && c >= 0 && c < columns &&
+                       board.symbolAt(r * columns + c) == mark) {
+                    length++;
+                    r += step[0];
+                    c += step[1];
+                }
+                if (length == k) return true;
+            }
+    return false;
+}
+
+// Random games on growing boards, timing each move with the incremental
+// check and with a full-board scan after every move
+void benchmarkBoardSizes(size_t movesPerSize) {
+    struct Size { int rows, columns, k; };
+    const Size sizes[] = {{3, 3, 3}, {7, 7, 4}, {15, 15, 5}, {31, 31, 5}, {63, 63, 5}, {127, 127, 5}};
+    mt19937 random(1);
+
+    cout << " Board   k   incremental ns/move   full scan ns/move\n";
+    for (const Size& size : sizes) {
+        MNKBoard board(size.rows, size.columns, size.k);
+        double times[2];
+        for (int scan = 0; scan < 2; scan++) {
+            // The scan is far slower on big boards, so it gets fewer moves
+            size_t budget = scan ? max<size_t>(1000, movesPerSize / board.cellCount()) : movesPerSize;
+            size_t moves = 0, wins = 0;
+            auto start = chrono::steady_clock::now();
+            while (moves < budget) {
+                board.clear();
+                while (!board.isOver()) {
+                    const vector<int>& free = board.getEmptyCells();
+                    int player = board.playerToMove();
+                    bool won = board.place(free[random() % free.size()], player);
+                    if (scan && scanForWin(board, player) != won) cout << "RESULTS DIFFER!\n";
+                    moves++;
+                }
+                wins += board.getWinner() >= 0;
+            }
+            times[scan] = chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1e9 / moves;
+        }
+        cout << setw(4) << size.rows << "x" << left << setw(4) << size.columns << right << setw(2) << size.k
+             << fixed << setprecision(1) << setw(18) << times[0] << setw(20) << times[1] << "\n"
+             << resetiosflags(ios::fixed);
+    }
+}
+
+// Playouts per second from the empty board with 1, 2, 4, ... threads up to maxThreads
+void benchmarkMCTS(int rows, int columns, int k, double seconds, int maxThreads) {
+    MNKBoard board(rows, columns, k);
+    cout << "MCTS on " << rows << "x" << columns << ", " << k << " in a row, " << seconds << " s per search\n"
+         << " Threads   playouts/s   speedup     nodes   move\n";
+    double single = 0;
+    for (int threads = 1;; threads = min(threads * 2, maxThreads)) {
+        MCTSPlayer engine(threads);
+        MCTSPlayer::Result result = engine.search(board, seconds);
+        double rate = result.playouts / result.seconds;
+        if (threads == 1) single = rate;
+        cout << setw(8) << threads << setw(13) << static_cast<long long>(rate) << fixed << setprecision(2)
+             << setw(9) << rate / single << "x" << resetiosflags(ios::fixed) << setw(10) << result.nodes
+             << "   " << result.move / columns + 1 << " " << result.move % columns + 1 << "\n";
+        if (threads >= maxThreads) break;
+    }
+}
+
+// Runs a tournament from the command line. From argv[first] on: games,
+// threads, comma-separated players ("random", "alphabeta", "mcts" or
+// "mcts:<playouts>"), then an optional board size. Games are recorded to
+// recordPath when it is given.
+int runTournament(int argc, char* argv[], int first, const char* recordPath) {
+    auto argument = [&](int offset) -> const char* { return first + offset < argc ? argv[first + offset] : nullptr; };
+    size_t games = argument(0) ? strtoull(argument(0), nullptr, 10) : 100000;
+    int threads = argument(1) ? atoi(argument(1)) : 0;
+    string list = argument(2) ? argument(2) : "random,alphabeta,mcts";
+    bool sized = argument(5) != nullptr;
+    int rows = sized ? atoi(argument(3)) : 3, columns = sized ? atoi(argument(4)) : 3, k = sized ? atoi(argument(5)) : 3;
+    if (rows < 1 || rows > 99 || columns < 1 || columns > 99 || k < 1 || k > max(rows, columns)) {
+        cout << "Rows and columns must be 1-99, and k at most the longer side.\n";
+        return 1;
+    }
+
+    vector<PlayerSpec> players;
+    vector<string> names;
+    stringstream items(list);
+    string item;
+    while (getline(items, item, ',')) {
+        PlayerSpec spec{item, 200};
+        if (item.compare(0, 5, "mcts:") == 0) {
+            spec.name = "mcts";
+            spec.playouts = max<size_t>(1, strtoull(item.c_str() + 5, nullptr, 10));
+        }
+        if (spec.name != "random" && spec.name != "alphabeta" && spec.name != "mcts") {
+            cout << "Unknown player \"" << item << "\"; use random, alphabeta or mcts[:playouts].\n";
+            return 1;
+        }
+        if (spec.name == "alphabeta" && (rows != 3 || columns != 3 || k != 3)) {
+            cout << "The alphabeta player only plays 3x3 boards with 3 in a row.\n";
+            return 1;
+        }
+        players.push_back(spec);
+        names.push_back(item);
+    }
+    if (players.empty()) return 1;
+
+    GameRecordWriter records;
+    if (recordPath && !records.open(recordPath, rows, columns, k)) {
+        cout << "Could not open " << recordPath << " (or it is damaged, or holds games on another board size).\n";
+        return 1;
+    }
+
+    Tournament tournament(rows, columns, k, players, threads);
+    size_t perPairing = max<size_t>(1, games / tournament.pairingCount());
+    Tournament::Results results = tournament.run(perPairing, 1, recordPath ? &records : nullptr);
+    if (recordPath && (!records.close() || results.recordFailed)) {
+        cout << "Could not write every game to " << recordPath << "; the games after the last whole one "
+             << "written are dropped when more are recorded.\n";
+        return 1;
+    }
+
+    cout << results.games << " games on " << rows << "x" << columns << " (" << k << " in a row) in "
+         << fixed << setprecision(2) << results.seconds << " s: "
+         << static_cast<long long>(results.games / max(results.seconds, 1e-9)) << " games/s, "
+         << results.steals << " steals\n\n"
+         << "X wins / draws / O wins (%), X down the side and O across the top\n" << setw(12) << "";
+    for (const string& name : names) cout << setw(18) << name;
+    cout << "\n";
+    for (size_t x = 0; x < players.size(); x++) {
+        cout << left << setw(12) << names[x] << right;
+        for (size_t o = 0; o < players.size(); o++) {
+            const array<size_t, 3>& outcome = results.outcomes[x * players.size() + o];
+            double total = max<size_t>(1, outcome[0] + outcome[1] + outcome[2]) / 100.0;
+            ostringstream cell;
+            cell << fixed << setprecision(1) << outcome[0] / total << "/" << outcome[1] / total << "/"
+                 << outcome[2] / total;
+            cout << setw(18) << cell.str();
+        }
+        cout << "\n";
+    }
+
+    // Think-time percentiles are the upper edges of their log2 buckets
+    cout << "\nThink time per move\n" << left << setw(12) << "" << right << setw(12) << "moves"
+         << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "p99.9" << "\n";
+    for (size_t player = 0; player < players.size(); player++) {
+        const auto& histogram = results.thinkTimes[player];
+        size_t moves = 0;
+        for (size_t count : histogram) moves += count;
+        cout << left << setw(12) << names[player] << right << setw(12) << moves;
+        for (double quantile : {0.5, 0.99, 0.999}) {
+            size_t seen = 0;
+            int bucket = 0;
+            while (bucket < Tournament::TIME_BUCKETS - 1 && seen + histogram[bucket] < quantile * moves)
+                seen += histogram[bucket++];
+            double nanoseconds = double(2LL << bucket);
+            ostringstream cell;
+            if (nanoseconds < 1e3) cell << "<" << nanoseconds << "ns";
+            else if (nanoseconds < 1e6) cell << "<" << setprecision(3) << nanoseconds / 1e3 << "us";
+            else cell << "<" << setprecision(3) << nanoseconds / 1e6 << "ms";
+            cout << setw(10) << cell.str();
+        }
+        cout << "\n";
+    }
+    cout << resetiosflags(ios::fixed);
+    return 0;
+}
+
+#ifdef __linux__
+// Summarises a recorded games file, then either replays one game (query is
+// its number) or lists the games reaching a 3x3 position (query is 9 cells
+// of X, O or ., row by row)
+int queryGames(const char* path, const char* query) {
+    auto start = chrono::steady_clock::now();
+    GameRecordFile file;
+    if (!file.open(path)) {
+        cout << "Could not read " << path << " as a recorded games file.\n";
+        return 1;
+    }
+    double openSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t results[3] = {0, 0, 0};
+    size_t moves = 0;
+    for (size_t index = 0; index < file.gameCount(); index++) results[file.result(index)]++;
+    for (size_t index = 0; index < min<size_t>(file.gameCount(), 100000); index++) moves += file.game(index).moves.size();
+    double sampled = double(min<size_t>(file.gameCount(), 100000));
+    double bytesPerGame = double(file.byteCount() - GAMES_HEADER_BYTES) / max<size_t>(1, file.gameCount());
+
+    cout << fixed << setprecision(2) << file.gameCount() << " games on " << file.getRows() << "x"
+         << file.getColumns() << " (" << file.getK() << " in a row): " << file.byteCount() << " bytes, "
+         << bytesPerGame << " bytes/game, " << bytesPerGame * 8 / max(1.0, moves / max(1.0, sampled))
+         << " bits/move; opened in " << openSeconds * 1e3 << " ms"
+         << (!file.indexWasSaved()    ? ", scanning every record"
+             : file.newGameCount() ? " from its index file and " + to_string(file.newGameCount()) + " new game(s)"
+                                   : " from its index file")
+         << "\n"
+         << "X won " << results[0] << ", drawn " << results[1] << ", O won " << results[2] << "\n";
+    if (file.tornByteCount())
+        cout << "The last " << file.tornByteCount() << " byte(s) are part of a game cut off while recording; "
+             << "they are ignored, and dropped when more games are recorded.\n";
+
+    if (query && isdigit(static_cast<unsigned char>(query[0]))) {
+        size_t index = strtoull(query, nullptr, 10);
+        if (index >= file.gameCount()) {
+            cout << "There is no game " << index << ".\n";
+            return 1;
+        }
+        GameRecordFile::Game game = file.game(index);
+        MNKBoard board(file.getRows(), file.getColumns(), file.getK());
+        cout << "\nGame " << index << ":";
+        for (int cell : game.moves) {
+            cout << " " << (board.playerToMove() ? 'O' : 'X') << "@"
+                 << cell / file.getColumns() + 1 << "," << cell % file.getColumns() + 1;
+            board.place(cell, board.playerToMove());
+        }
+        cout << "\n";
+        for (int row = 0; row < board.getRows(); row++) {
+            for (int column = 0; column < board.getColumns(); column++)
+                cout << " " << board.symbolAt(row * board.getColumns() + column);
+            cout << "\n";
+        }
+        cout << (game.result == 1 ? "Drawn" : game.result == 0 ? "X won" : "O won") << "\n";
+        return 0;
+    }
+
+    start = chrono::steady_clock::now();
+    if (!file.buildPositionIndex()) {
+        if (query) cout << "Only 3x3 files have a position index.\n";
+        return query ? 1 : 0;
+    }
+    double indexSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Position index ready in " << indexSeconds * 1e3 << " ms\n";
+
+    if (!query) {
+        // Every reachable position once, to time lookups
+        size_t positions = 0, matches = 0;
+        start = chrono::steady_clock::now();
+        for (int code = 0; code < POSITION_CODES; code++) {
+            if (SOLVED.score[code] == UNSOLVED) continue;
+            uint16_t marks[2] = {0, 0};
+            for (int cell = 0, rest = code; cell < 9; cell++, rest /= 3)
+                if (rest % 3) marks[rest % 3 - 1] |= uint16_t(1u << cell);
+            auto games = file.gamesReaching(marks[0], marks[1]);
+            matches += games.second - games.first;
+            positions++;
+        }
+        double lookupSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Looked up all " << positions << " reachable positions in " << lookupSeconds * 1e3 << " ms ("
+             << lookupSeconds * 1e9 / positions << " ns each, " << matches << " matching games)\n"
+             << resetiosflags(ios::fixed);
+        return 0;
+    }
+
+    uint16_t marks[2] = {0, 0};
+    bool valid = strlen(query) == 9;
+    for (int cell = 0; valid && cell < 9; cell++) {
+        char symbol = static_cast<char>(toupper(query[cell]));
+        if (symbol == 'X' || symbol == 'O') marks[symbol == 'O'] |= uint16_t(1u << cell);
+        else valid = symbol == '.';
+    }
+    int xCount = __builtin_popcount(marks[0]), oCount = __builtin_popcount(marks[1]);
+    if (!valid || xCount - oCount < 0 || xCount - oCount > 1) {
+        cout << "A position is 9 cells of X, O or . (row by row), with X moving first.\n";
+        return 1;
+    }
+
+    start = chrono::steady_clock::now();
+    auto games = file.gamesReaching(marks[0], marks[1]);
+    size_t reached[3] = {0, 0, 0};
+    for (const uint32_t* game = games.first; game != games.second; game++) reached[file.result(*game)]++;
+    double querySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << (games.second - games.first) << " games reach " << query << " or a rotation or reflection of it ("
+         << querySeconds * 1e6 << " us): X won " << reached[0] << ", drawn " << reached[1] << ", O won "
+         << reached[2] << "\n";
+    if (games.first != games.second) {
+        cout << "First games:";
+        for (const uint32_t* game = games.first; game != games.second && game < games.first + 10; game++)
+            cout << " " << *game;
+        cout << "\n";
+    }
+    cout << resetiosflags(ios::fixed);
+    return 0;
+}
+#endif
+
+// Plays interactive games until the players have had enough; computer is
+// the side the computer plays, or 0 for two humans
+void playInteractive(char computer) {
+    if (computer)
+        cout << "Welcome to Tic-Tac-Toe! You are " << (computer == 'X' ? 'O' : 'X')
+             << " and the computer is " << computer << ". X goes first.\n";
+    else
+        cout << "Welcome to Tic-Tac-Toe! Player 1 is X, Player 2 is O.\n";
     cout << "Use numbers (1-9) to choose a position:\n";
     cout << " 1 | 2 | 3 \n";
     cout << "---+---+---\n";
@@ -169,7 +2045,7 @@ int main() {
 
     char playAgain;
     do {
-        TicTacToe game;
+        TicTacToe game(computer);
         game.play();
         cout << "Want to play another round? (y/n): ";
         cin >> playAgain;
@@ -177,5 +2053,77 @@ int main() {
     } while (playAgain == 'y' || playAgain == 'Y');
 
     cout << "Thanks for playing Tic-Tac-Toe! See you next time!\n";
-    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 1) {
+        playInteractive(0);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--vs-computer") == 0) {
+        char computer = argc > 2 ? static_cast<char>(toupper(argv[2][0])) : 'O';
+        if (computer == 'X' || computer == 'O') {
+            playInteractive(computer);
+            return 0;
+        }
+    }
+
+    if ((strcmp(argv[1], "--board") == 0 || strcmp(argv[1], "--bench-mcts") == 0) && argc > 4) {
+        int rows = atoi(argv[2]), columns = atoi(argv[3]), k = atoi(argv[4]);
+        if (rows < 1 || rows > 99 || columns < 1 || columns > 99 || k < 1 || k > max(rows, columns)) {
+            cout << "Rows and columns must be 1-99, and k at most the longer side.\n";
+            return 1;
+        }
+        if (strcmp(argv[1], "--bench-mcts") == 0) {
+            int cores = static_cast<int>(max(1u, thread::hardware_concurrency()));
+            benchmarkMCTS(rows, columns, k, argc > 5 ? atof(argv[5]) : 1.0, argc > 6 ? atoi(argv[6]) : cores);
+            return 0;
+        }
+        char computer = argc > 5 ? static_cast<char>(toupper(argv[5][0])) : 0;
+        if (computer == 'X' || computer == 'O' || computer == 0) {
+            MNKGame game(rows, columns, k, computer, argc > 6 ? atof(argv[6]) : 1.0);
+            game.play();
+            return 0;
+        }
+    }
+
+    if (strcmp(argv[1], "--bench-boards") == 0) {
+        benchmarkBoardSizes(argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--tournament") == 0)
+        return runTournament(argc, argv, 2, nullptr);
+
+    if (strcmp(argv[1], "--record") == 0 && argc > 2)
+        return runTournament(argc, argv, 3, argv[2]);
+
+#ifdef __linux__
+    if (strcmp(argv[1], "--games") == 0 && argc > 2)
+        return queryGames(argv[2], argc > 3 ? argv[3] : nullptr);
+#endif
+
+    if (strcmp(argv[1], "--solve") == 0) {
+        runSolverCheck();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--bench") == 0) {
+        benchmarkWinChecks(argc > 2 ? strtoull(argv[2], nullptr, 10) : 100000000);
+        return 0;
+    }
+
+    cout << "Usage:\n"
+         << "  " << argv[0] << "                                                     play interactively\n"
+         << "  " << argv[0] << " --vs-computer [X|O]                                 play against the perfect player (default O)\n"
+         << "  " << argv[0] << " --solve                                             check and time the alpha-beta solver\n"
+         << "  " << argv[0] << " --board <m> <n> <k> [X|O [s]]                       m x n board, k in a row; X or O is the MCTS side\n"
+         << "  " << argv[0] << " --tournament [games] [threads] [players] [m n k]    headless games between random,alphabeta,mcts[:playouts]\n"
+         << "  " << argv[0] << " --record <file> [games] [threads] [players] [m n k] the same, appending every game to a games file\n"
+         << "  " << argv[0] << " --games <file> [game|position]                      summarise, replay a game or find games reaching a 3x3 position\n"
+         << "  " << argv[0] << " --bench [checks]                                    time win/draw detection\n"
+         << "  " << argv[0] << " --bench-boards [moves]                              time moves on growing m x n boards\n"
+         << "  " << argv[0] << " --bench-mcts <m> <n> <k> [s] [threads]              MCTS playouts/s as threads are added\n";
+    return 1;
 }
@@ -1,178 +1,4291 @@
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <limits>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <random>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <queue>
+#include <unordered_map>
+#include <memory>
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <fcntl.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 using namespace std;
 
-// Class representing a single task
+// Files holding the saved list: <prefix>.snapshot plus log segments <prefix>.wal.<n>
+const string DATA_PREFIX = "todo_list";
+
+// A single task as its own object, with its own heap string. The list
+// itself keeps tasks in a TaskSlotMap; this is the layout it replaced,
+// kept for the benchmarks to compare against.
 class Task {
 private:
     string description;  // Task description
     bool completed;      // Status: true if task is completed
 
 public:
-    Task(const string& desc) : description(desc), completed(false) {}
+    Task(string desc, bool done = false) : description(move(desc)), completed(done) {}
 
-    string getDescription() const { return description; }  // Returns task description
+    const string& getDescription() const { return description; }  // Returns task description
     bool isCompleted() const { return completed; }         // Returns completion status
 
     void markCompleted() { completed = true; }             // Marks the task as completed
 };
 
-// Class for input validation and user prompts
-class InputManager {
+// Stable handle for a task: its slot plus that slot's generation. A slot's
+// generation goes up whenever its task is removed, so an old ID can never
+// reach a task added later in the same slot.
+struct TaskId {
+    uint32_t slot;
+    uint32_t generation;
+
+    // The number shown to users: slot + 1 for a slot's first task, with
+    // the generation in the high bits after that, so it is never 0
+    uint64_t number() const { return uint64_t(generation) << 32 | (uint64_t(slot) + 1); }
+    static TaskId fromNumber(uint64_t number) {
+        return TaskId{static_cast<uint32_t>(number - 1), static_cast<uint32_t>((number - 1) >> 32)};
+    }
+};
+
+// Description bytes for every task, packed into large blocks instead of
+// one heap string per task. A removed description stays behind as garbage
+// until the owner copies the live ones into a fresh arena.
+class StringArena {
 public:
-    // Prompt user for menu choice between 1 and 5
-    int getMenuChoice() {
-        int choice;
-        while (true) {
-            cout << "Enter your choice (1-5): ";
-            cin >> choice;
-            if (cin.fail() || choice < 1 || choice > 5) {
-                cin.clear();
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                cout << "Please enter a number between 1 and 5.\n";
-            } else {
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                return choice;
-            }
+    struct Ref {
+        uint32_t block;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+    vector<vector<char>> blocks; // Never filled past their reserved size, so views stay valid
+    size_t liveBytes = 0;
+    size_t garbageBytes = 0;
+
+public:
+    Ref add(string_view text) {
+        if (blocks.empty() || blocks.back().capacity() - blocks.back().size() < text.size()) {
+            blocks.emplace_back();
+            blocks.back().reserve(max(BLOCK_SIZE, text.size()));
         }
+        vector<char>& block = blocks.back();
+        Ref ref{static_cast<uint32_t>(blocks.size() - 1), static_cast<uint32_t>(block.size()),
+                static_cast<uint32_t>(text.size())};
+        block.insert(block.end(), text.begin(), text.end());
+        liveBytes += text.size();
+        return ref;
     }
 
-    // Prompt user for a valid task index
-    int getTaskIndex(int maxSize) {
-        int index;
-        while (true) {
-            cout << "Enter task number (1-" << maxSize << "): ";
-            cin >> index;
-            if (cin.fail() || index < 1 || index > maxSize) {
-                cin.clear();
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                cout << "Please enter a number between 1 and " << maxSize << ".\n";
-            } else {
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                return index - 1;  // Adjust for 0-based indexing
-            }
+    // Makes sure the next bytes of adds go in one block (for bulk loads)
+    void reserve(size_t bytes) {
+        bytes = min(bytes, size_t(UINT32_MAX));
+        if (blocks.empty() || blocks.back().capacity() - blocks.back().size() < bytes) {
+            blocks.emplace_back();
+            blocks.back().reserve(max(BLOCK_SIZE, bytes));
         }
     }
 
-    // Prompt user for a non-empty task description
-    string getTaskDescription() {
-        string desc;
-        while (true) {
-            cout << "Enter task description: ";
-            getline(cin, desc);
-            if (desc.empty()) {
-                cout << "Task description cannot be empty. Try again!\n";
-            } else {
-                return desc;
-            }
+    string_view get(Ref ref) const { return string_view(blocks[ref.block].data() + ref.offset, ref.length); }
+
+    void release(Ref ref) {
+        liveBytes -= ref.length;
+        garbageBytes += ref.length;
+    }
+
+    // True once at least 1 MB, and more than half the bytes, are garbage
+    bool wantsCompaction() const { return garbageBytes > BLOCK_SIZE && garbageBytes > liveBytes; }
+    size_t getLiveBytes() const { return liveBytes; }
+};
+
+// Days since 1970-01-01 for a date in the proleptic Gregorian calendar
+constexpr int32_t daysFromCivil(int year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int32_t>(dayOfEra) - 719468;
+}
+
+// The calendar date of a day number
+void civilFromDays(int32_t days, int& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned shifted = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+    month = shifted < 10 ? shifted + 3 : shifted - 9;
+    year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2);
+}
+
+// The date of a day number, as YYYY-MM-DD
+string formatDay(int32_t days) {
+    int year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+    char text[32];
+    snprintf(text, sizeof(text), "%04d-%02u-%02u", year, month, day);
+    return text;
+}
+
+// Reads a YYYY-MM-DD date; false unless it is a real calendar date
+bool parseDay(string_view text, int32_t& days) {
+    static const unsigned DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    unsigned value[3] = {0, 0, 0};
+    for (size_t i = 0, field = 0; i < text.size(); i++) {
+        if (i == 4 || i == 7) {
+            field++;
+        } else if (text[i] >= '0' && text[i] <= '9') {
+            value[field] = value[field] * 10 + static_cast<unsigned>(text[i] - '0');
+        } else {
+            return false;
         }
     }
+    int year = static_cast<int>(value[0]);
+    unsigned month = value[1], day = value[2];
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (month < 1 || month > 12 || day < 1 || day > DAYS_IN_MONTH[month - 1] + (month == 2 && leap)) return false;
+    days = daysFromCivil(year, month, day);
+    return true;
+}
+
+// Today's local date as a day number
+int32_t today() {
+    time_t now = time(nullptr);
+    tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    return daysFromCivil(local.tm_year + 1900, static_cast<unsigned>(local.tm_mon + 1), static_cast<unsigned>(local.tm_mday));
+}
+
+// When a task should be done: a priority from 1 (most urgent) to 5, and
+// an optional due date as a day number
+struct TaskSchedule {
+    static const uint8_t DEFAULT_PRIORITY = 3;
+    static constexpr int32_t NO_DUE_DATE = INT32_MAX;
+
+    uint8_t priority = DEFAULT_PRIORITY;
+    int32_t dueDay = NO_DUE_DATE;
+
+    bool hasDueDate() const { return dueDay != NO_DUE_DATE; }
+    bool isDefault() const { return priority == DEFAULT_PRIORITY && !hasDueDate(); }
 };
 
-// Abstract base class for list managers
-class BaseListManager {
-protected:
-    InputManager input;  // For managing user input
+// Tasks in a generational slot map: adding, finding, completing and
+// removing are all O(1) and IDs never change. Freed slots are reused, with
+// a new generation, oldest first and only once MIN_FREE of them have piled
+// up, so short lists keep small IDs. A linked list through the slots keeps
+// the order tasks were added in, for display.
+//
+// Slots are stored as parallel arrays (about 32 bytes each) with the
+// descriptions in a StringArena, and whether a slot is in use or completed
+// is kept in bitsets, so counting or listing completed tasks scans 64
+// slots per word. Views returned by description() stay valid until the
+// next add or remove.
+class TaskSlotMap {
 public:
-    virtual ~BaseListManager() = default;
-    virtual void run() = 0;  // Pure virtual function to be implemented by derived class
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static const size_t MIN_FREE = 1024;
+
+private:
+    StringArena arena;
+    vector<StringArena::Ref> descriptions;
+    vector<uint32_t> generations;
+    vector<TaskSchedule> schedules;
+    vector<uint32_t> previous;        // Display order, or the previous free slot when unoccupied
+    vector<uint32_t> next;            // Display order, or the next free slot when unoccupied
+    vector<uint64_t> occupiedBits;
+    vector<uint64_t> completedBits;
+    vector<uint64_t> freeBits;        // Slots on the free list
+    uint32_t freeHead = NONE;         // Free slots, oldest first
+    uint32_t freeTail = NONE;
+    size_t freeCount = 0;
+    uint32_t first = NONE;
+    uint32_t last = NONE;
+    size_t count = 0;
+
+    static bool testBit(const vector<uint64_t>& bits, uint32_t slot) { return bits[slot >> 6] >> (slot & 63) & 1; }
+    static void setBit(vector<uint64_t>& bits, uint32_t slot) { bits[slot >> 6] |= 1ULL << (slot & 63); }
+    static void clearBit(vector<uint64_t>& bits, uint32_t slot) { bits[slot >> 6] &= ~(1ULL << (slot & 63)); }
+
+    // Adds unoccupied slots up to and including slot
+    void growTo(uint32_t slot) {
+        size_t size = size_t(slot) + 1;
+        if (size <= generations.size()) return;
+        descriptions.resize(size, StringArena::Ref{0, 0, 0});
+        generations.resize(size, 0);
+        schedules.resize(size);
+        previous.resize(size, NONE);
+        next.resize(size, NONE);
+        occupiedBits.resize((size + 63) / 64, 0);
+        completedBits.resize((size + 63) / 64, 0);
+        freeBits.resize((size + 63) / 64, 0);
+    }
+
+    void pushFree(uint32_t slot) {
+        previous[slot] = freeTail;
+        next[slot] = NONE;
+        if (freeTail == NONE) freeHead = slot;
+        else next[freeTail] = slot;
+        freeTail = slot;
+        freeCount++;
+        setBit(freeBits, slot);
+    }
+
+    // Takes a slot off the free list, from wherever it is
+    void unlinkFree(uint32_t slot) {
+        if (previous[slot] == NONE) freeHead = next[slot];
+        else next[previous[slot]] = next[slot];
+        if (next[slot] == NONE) freeTail = previous[slot];
+        else previous[next[slot]] = previous[slot];
+        freeCount--;
+        clearBit(freeBits, slot);
+    }
+
+    // Links slot into display order before the occupied slot before, or
+    // at the end for NONE
+    void link(uint32_t slot, uint32_t before = NONE) {
+        uint32_t after = before == NONE ? last : previous[before];
+        previous[slot] = after;
+        next[slot] = before;
+        if (after == NONE) first = slot;
+        else next[after] = slot;
+        if (before == NONE) last = slot;
+        else previous[before] = slot;
+    }
+
+    void occupy(uint32_t slot, string_view description, bool completed, uint32_t before = NONE) {
+        descriptions[slot] = arena.add(description);
+        schedules[slot] = TaskSchedule();
+        setBit(occupiedBits, slot);
+        if (completed) setBit(completedBits, slot);
+        link(slot, before);
+        count++;
+    }
+
+    // Copies the live descriptions into a fresh arena, dropping the garbage
+    void compactArena() {
+        StringArena fresh;
+        for (uint32_t slot = first; slot != NONE; slot = next[slot])
+            descriptions[slot] = fresh.add(arena.get(descriptions[slot]));
+        arena = move(fresh);
+    }
+
+public:
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t slotCount() const { return generations.size(); }
+
+    TaskId add(string_view description, bool completed = false) {
+        uint32_t slot;
+        if (freeCount < MIN_FREE) {
+            slot = static_cast<uint32_t>(generations.size());
+            growTo(slot);
+        } else {
+            slot = freeHead;
+            unlinkFree(slot);
+        }
+        occupy(slot, description, completed);
+        return TaskId{slot, generations[slot]};
+    }
+
+    // Reserves room for count more slots, for bulk loads
+    void reserve(size_t more) {
+        size_t size = generations.size() + more;
+        descriptions.reserve(size);
+        generations.reserve(size);
+        schedules.reserve(size);
+        previous.reserve(size);
+        next.reserve(size);
+        occupiedBits.reserve((size + 63) / 64);
+        completedBits.reserve((size + 63) / 64);
+        freeBits.reserve((size + 63) / 64);
+    }
+
+    // Starts a bulk load (from a snapshot): empties the map and gives it
+    // slots unoccupied slots in one step, with arena room for
+    // descriptionBytes. Generations are then set with setGeneration() and
+    // tasks appended in display order with load().
+    void startLoad(size_t slots, size_t descriptionBytes) {
+        *this = TaskSlotMap();
+        if (slots > 0) growTo(static_cast<uint32_t>(slots - 1));
+        arena.reserve(descriptionBytes);
+    }
+
+    // Puts a task in a slot from startLoad(), after all the tasks loaded so
+    // far; false if the slot is out of range or already taken
+    bool load(uint32_t slot, string_view description, bool completed, TaskSchedule schedule) {
+        if (slot >= generations.size() || testBit(occupiedBits, slot)) return false;
+        descriptions[slot] = arena.add(description);
+        schedules[slot] = schedule;
+        setBit(occupiedBits, slot);
+        if (completed) setBit(completedBits, slot);
+        link(slot);
+        count++;
+        return true;
+    }
+
+    // Puts a task back under a known ID (when loading a saved list); the
+    // free list must be rebuilt with rebuildFreeList() afterwards
+    bool restore(TaskId id, string_view description, bool completed = false) {
+        if (id.slot == NONE) return false;
+        growTo(id.slot);
+        if (testBit(occupiedBits, id.slot)) return false;
+        if (testBit(freeBits, id.slot)) unlinkFree(id.slot);
+        generations[id.slot] = id.generation;
+        occupy(id.slot, description, completed);
+        return true;
+    }
+
+    // Puts a removed task back under its ID, before the task before in
+    // display order, or at the end if before is not on the list (for undo)
+    bool restoreAt(TaskId id, string_view description, bool completed, TaskId before) {
+        if (id.slot == NONE || id.generation == UINT32_MAX) return false;
+        growTo(id.slot);
+        if (testBit(occupiedBits, id.slot)) return false;
+        if (testBit(freeBits, id.slot)) unlinkFree(id.slot);
+        generations[id.slot] = id.generation;
+        occupy(id.slot, description, completed, contains(before) ? before.slot : NONE);
+        return true;
+    }
+
+    // Sets an unoccupied slot's generation (when loading a saved list)
+    void setGeneration(uint32_t slot, uint32_t generation) {
+        growTo(slot);
+        if (!testBit(occupiedBits, slot)) generations[slot] = generation;
+    }
+
+    void rebuildFreeList() {
+        freeHead = freeTail = NONE;
+        freeCount = 0;
+        fill(freeBits.begin(), freeBits.end(), 0);
+        for (uint32_t slot = 0; slot < generations.size(); slot++)
+            if (!testBit(occupiedBits, slot) && generations[slot] != UINT32_MAX) pushFree(slot);
+    }
+
+    bool contains(TaskId id) const {
+        return id.slot < generations.size() && testBit(occupiedBits, id.slot) && generations[id.slot] == id.generation;
+    }
+
+    // Only for IDs that contains() accepts
+    string_view description(TaskId id) const { return arena.get(descriptions[id.slot]); }
+    bool isCompleted(TaskId id) const { return testBit(completedBits, id.slot); }
+
+    const TaskSchedule& schedule(TaskId id) const { return schedules[id.slot]; }
+
+    bool setSchedule(TaskId id, TaskSchedule schedule) {
+        if (!contains(id)) return false;
+        schedules[id.slot] = schedule;
+        return true;
+    }
+
+    bool markCompleted(TaskId id) {
+        if (!contains(id)) return false;
+        setBit(completedBits, id.slot);
+        return true;
+    }
+
+    bool markPending(TaskId id) {
+        if (!contains(id)) return false;
+        clearBit(completedBits, id.slot);
+        return true;
+    }
+
+    bool remove(TaskId id) {
+        if (!contains(id)) return false;
+        uint32_t slot = id.slot;
+        if (previous[slot] == NONE) first = next[slot];
+        else next[previous[slot]] = next[slot];
+        if (next[slot] == NONE) last = previous[slot];
+        else previous[next[slot]] = previous[slot];
+
+        arena.release(descriptions[slot]);
+        clearBit(occupiedBits, slot);
+        clearBit(completedBits, slot);
+        // A slot whose generation would wrap is retired rather than reused
+        if (++generations[slot] != UINT32_MAX) pushFree(slot);
+        count--;
+        if (arena.wantsCompaction()) compactArena();
+        return true;
+    }
+
+    // ID of the task in an occupied slot
+    TaskId idOfSlot(uint32_t slot) const { return TaskId{slot, generations[slot]}; }
+
+    bool isOccupied(uint32_t slot) const { return slot < generations.size() && testBit(occupiedBits, slot); }
+
+    // Neighbours of an occupied slot in display order, NONE at the ends
+    uint32_t slotBefore(uint32_t slot) const { return previous[slot]; }
+    uint32_t slotAfter(uint32_t slot) const { return next[slot]; }
+    uint32_t lastSlot() const { return last; }
+
+    // Generation a slot's next task would get (for saving the list)
+    uint32_t generationOf(uint32_t slot) const { return generations[slot]; }
+
+    size_t completedCount() const {
+        size_t total = 0;
+        for (uint64_t word : completedBits) total += __builtin_popcountll(word);
+        return total;
+    }
+    size_t pendingCount() const { return count - completedCount(); }
+
+    // Calls visit(id, description, completed) for every task in display order
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (uint32_t slot = first; slot != NONE; slot = next[slot])
+            visit(TaskId{slot, generations[slot]}, arena.get(descriptions[slot]), testBit(completedBits, slot));
+    }
+
+    // Calls visit(id, description) for every completed task, in slot order
+    // (the same as display order unless slots have been reused)
+    template <typename Visit>
+    void forEachCompleted(Visit visit) const {
+        for (size_t word = 0; word < completedBits.size(); word++)
+            for (uint64_t bits = completedBits[word]; bits; bits &= bits - 1) {
+                uint32_t slot = static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits));
+                visit(TaskId{slot, generations[slot]}, arena.get(descriptions[slot]));
+            }
+    }
+
+    // Bytes held by the slot arrays and the arena's live descriptions
+    size_t memoryBytes() const {
+        return generations.size() * (sizeof(StringArena::Ref) + sizeof(TaskSchedule) + 3 * sizeof(uint32_t)) +
+               occupiedBits.size() * 3 * sizeof(uint64_t) + arena.getLiveBytes();
+    }
 };
 
-// Class that manages the to-do list
-class ToDoList : public BaseListManager {
+// Which tasks a search or listing should include
+enum class TaskFilter { All, Pending, Completed };
+
+// Inverted index from the words in task descriptions to the slots of the
+// tasks that contain them. Words are runs of letters and digits, lowercased
+// (bytes outside ASCII count as letters, so other scripts still index).
+// Each word's postings are kept sorted, in blocks of up to BLOCK_SIZE slots
+// stored as varint gaps, so a term shared by millions of tasks costs a byte
+// or two per task and a single slot can be inserted or removed by
+// rewriting one block.
+class TaskSearchIndex {
 private:
-    vector<Task> tasks;  // Vector to store all tasks
+    static const size_t BLOCK_SIZE = 128;
 
-    // Display the list of tasks
-    void viewTasks() const {  // Removed 'override' since it's not overriding a base class method
-        if (tasks.empty()) {
-            cout << "Your to-do list is empty. Add some tasks!\n";
-            return;
+    struct PostingBlock {
+        uint32_t first = 0;      // Smallest slot; not stored in gaps
+        uint32_t last = 0;       // Largest slot, for skipping whole blocks
+        uint32_t count = 0;
+        vector<uint8_t> gaps;    // Varint differences between later slots
+    };
+
+    struct PostingList {
+        vector<PostingBlock> blocks;
+        size_t count = 0;
+    };
+
+    static void putVarint(vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
         }
-        cout << "\nYour To-Do List:\n";
-        for (size_t i = 0; i < tasks.size(); i++) {
-            cout << (i + 1) << ". " << tasks[i].getDescription()
-                 << " [" << (tasks[i].isCompleted() ? "Completed" : "Pending") << "]\n";
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static void decode(const PostingBlock& block, vector<uint32_t>& out) {
+        uint32_t slot = block.first;
+        out.push_back(slot);
+        const uint8_t* p = block.gaps.data();
+        for (uint32_t i = 1; i < block.count; i++) {
+            uint32_t gap = 0;
+            for (int shift = 0;; shift += 7) {
+                uint8_t byte = *p++;
+                gap |= uint32_t(byte & 0x7F) << shift;
+                if (byte < 0x80) break;
+            }
+            slot += gap;
+            out.push_back(slot);
         }
-        cout << endl;
     }
 
-    // Add a new task to the list
-    void addTask() {
-        string desc = input.getTaskDescription();  // Get task description
-        tasks.push_back(Task(desc));               // Add to vector
-        cout << "Task added successfully!\n";
+    static PostingBlock encode(const uint32_t* begin, const uint32_t* end) {
+        PostingBlock block;
+        block.first = *begin;
+        block.last = end[-1];
+        block.count = static_cast<uint32_t>(end - begin);
+        block.gaps.reserve(block.count * 2);
+        for (const uint32_t* slot = begin + 1; slot < end; slot++) putVarint(block.gaps, *slot - slot[-1]);
+        return block;
     }
 
-    // Mark a specific task as completed
-    void markTaskCompleted() {
-        if (tasks.empty()) {
-            cout << "No tasks to mark. Add some tasks first!\n";
-            return;
-        }
-        viewTasks();  // Show tasks
-        int index = input.getTaskIndex(tasks.size());
-        if (tasks[index].isCompleted()) {
-            cout << "Task is already marked as completed.\n";
+    // First block whose last slot is at least slot
+    static size_t findBlock(const PostingList& list, uint32_t slot) {
+        return lower_bound(list.blocks.begin(), list.blocks.end(), slot,
+                           [](const PostingBlock& block, uint32_t value) { return block.last < value; }) -
+               list.blocks.begin();
+    }
+
+    // Rewrites block index from slots, splitting it in two if it is too big
+    static void replaceBlock(PostingList& list, size_t index, const vector<uint32_t>& slots) {
+        if (slots.empty()) {
+            list.blocks.erase(list.blocks.begin() + index);
+        } else if (slots.size() <= BLOCK_SIZE) {
+            list.blocks[index] = encode(slots.data(), slots.data() + slots.size());
         } else {
-            tasks[index].markCompleted();  // Mark selected task
-            cout << "Task marked as completed!\n";
+            size_t half = slots.size() / 2;
+            list.blocks[index] = encode(slots.data(), slots.data() + half);
+            list.blocks.insert(list.blocks.begin() + index + 1,
+                               encode(slots.data() + half, slots.data() + slots.size()));
         }
     }
 
-    // Remove a task from the list
-    void removeTask() {
-        if (tasks.empty()) {
-            cout << "No tasks to remove. Add some tasks first!\n";
+    static void insert(PostingList& list, uint32_t slot) {
+        if (list.blocks.empty() || slot > list.blocks.back().last) {
+            // New tasks usually get the highest slot yet, so this is the common case
+            if (list.blocks.empty() || list.blocks.back().count >= BLOCK_SIZE) {
+                list.blocks.push_back(encode(&slot, &slot + 1));
+            } else {
+                PostingBlock& block = list.blocks.back();
+                putVarint(block.gaps, slot - block.last);
+                block.last = slot;
+                block.count++;
+            }
+            list.count++;
             return;
         }
-        viewTasks();  // Show tasks
-        int index = input.getTaskIndex(tasks.size());
-        string desc = tasks[index].getDescription();  // Store description for confirmation
-        tasks.erase(tasks.begin() + index);           // Remove task from vector
-        cout << "Task \"" << desc << "\" removed successfully!\n";
+        size_t index = findBlock(list, slot);
+        vector<uint32_t> slots;
+        decode(list.blocks[index], slots);
+        auto position = lower_bound(slots.begin(), slots.end(), slot);
+        if (position != slots.end() && *position == slot) return;
+        slots.insert(position, slot);
+        replaceBlock(list, index, slots);
+        list.count++;
+    }
+
+    static void erase(PostingList& list, uint32_t slot) {
+        size_t index = findBlock(list, slot);
+        if (index == list.blocks.size() || list.blocks[index].first > slot) return;
+        vector<uint32_t> slots;
+        decode(list.blocks[index], slots);
+        auto position = lower_bound(slots.begin(), slots.end(), slot);
+        if (position == slots.end() || *position != slot) return;
+        slots.erase(position);
+        replaceBlock(list, index, slots);
+        list.count--;
     }
 
+    static vector<uint32_t> decodeAll(const PostingList& list) {
+        vector<uint32_t> slots;
+        slots.reserve(list.count);
+        for (const PostingBlock& block : list.blocks) decode(block, slots);
+        return slots;
+    }
+
+    // Keeps the candidates that are also in list, skipping blocks that
+    // cannot hold any of them
+    static void intersect(vector<uint32_t>& candidates, const PostingList& list) {
+        vector<uint32_t> block;
+        size_t decoded = SIZE_MAX;
+        size_t index = 0;
+        size_t kept = 0;
+        for (uint32_t slot : candidates) {
+            while (index < list.blocks.size() && list.blocks[index].last < slot) index++;
+            if (index == list.blocks.size()) break;
+            if (list.blocks[index].first > slot) continue;
+            if (decoded != index) {
+                block.clear();
+                decode(list.blocks[index], block);
+                decoded = index;
+            }
+            if (binary_search(block.begin(), block.end(), slot)) candidates[kept++] = slot;
+        }
+        candidates.resize(kept);
+    }
+
+    // One query word: a single term, or every term starting with a prefix
+    struct QueryTerm {
+        const PostingList* list = nullptr;
+        vector<uint32_t> slots;  // Prefix matches, already merged
+        size_t size() const { return list ? list->count : slots.size(); }
+    };
+
+    map<string, PostingList, less<>> terms;
+    string buffer;                 // Scratch space for add() and remove()
+    vector<string_view> words;
+
 public:
-    // Run the main loop of the to-do list manager
-    void run() override {
-        int choice;
-        do {
-            cout << "\nTo-Do List Manager\n";
-            cout << "1. Add Task\n";
-            cout << "2. View Tasks\n";
-            cout << "3. Mark Task as Completed\n";
-            cout << "4. Remove Task\n";
-            cout << "5. Exit\n";
-            choice = input.getMenuChoice();  // Get user's choice
+    // Lowercases text into buffer and sets words to views of its terms, in
+    // the order they appear. Both are reused from call to call.
+    static void splitWords(string_view text, string& buffer, vector<string_view>& words) {
+        buffer.resize(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (unsigned(c - 'A') < 26) c += 'a' - 'A';
+            bool letter = unsigned(c - 'a') < 26 || unsigned(c - '0') < 10 || c >= 0x80;
+            buffer[i] = letter ? static_cast<char>(c) : ' ';
+        }
+        words.clear();
+        for (size_t start = 0; start < buffer.size();) {
+            size_t end = buffer.find(' ', start);
+            if (end == string::npos) end = buffer.size();
+            if (end > start) words.push_back(string_view(buffer).substr(start, end - start));
+            start = end + 1;
+        }
+    }
 
-            switch (choice) {
-                case 1:
-                    addTask();
-                    break;
-                case 2:
-                    viewTasks();
-                    break;
-                case 3:
-                    markTaskCompleted();
-                    break;
-                case 4:
-                    removeTask();
-                    break;
-                case 5:
-                    cout << "Goodbye! Stay organized!\n";
-                    break;
+    // Like splitWords(), but with each term once, in sorted order
+    static void tokenize(string_view text, string& buffer, vector<string_view>& words) {
+        splitWords(text, buffer, words);
+        sort(words.begin(), words.end());
+        words.erase(unique(words.begin(), words.end()), words.end());
+    }
+
+    void add(uint32_t slot, string_view description) {
+        tokenize(description, buffer, words);
+        for (string_view word : words) {
+            auto found = terms.find(word);
+            if (found == terms.end()) found = terms.emplace(string(word), PostingList()).first;
+            insert(found->second, slot);
+        }
+    }
+
+    // description must be the one the slot was added with
+    void remove(uint32_t slot, string_view description) {
+        tokenize(description, buffer, words);
+        for (string_view word : words) {
+            auto found = terms.find(word);
+            if (found == terms.end()) continue;
+            erase(found->second, slot);
+            if (found->second.count == 0) terms.erase(found);
+        }
+    }
+
+    // Indexes every task at once: sorting (term, slot) pairs and encoding
+    // each list in one go is much faster than adding tasks one by one
+    void build(const TaskSlotMap& tasks) {
+        terms.clear();
+        unordered_map<string, uint32_t> numbers;   // Term -> position in names
+        vector<string> names;
+        vector<uint64_t> postings;                 // Term number << 32 | slot
+        postings.reserve(tasks.size() * 4);
+        string text;
+        tasks.forEach([&](TaskId id, string_view description, bool) {
+            tokenize(description, buffer, words);
+            for (string_view word : words) {
+                text.assign(word);
+                auto found = numbers.try_emplace(text, static_cast<uint32_t>(names.size())).first;
+                if (found->second == names.size()) names.push_back(text);
+                postings.push_back(uint64_t(found->second) << 32 | id.slot);
+            }
+        });
+        sort(postings.begin(), postings.end());
+
+        vector<uint32_t> slots;
+        for (size_t i = 0; i < postings.size();) {
+            uint32_t number = static_cast<uint32_t>(postings[i] >> 32);
+            slots.clear();
+            for (; i < postings.size() && postings[i] >> 32 == number; i++) slots.push_back(static_cast<uint32_t>(postings[i]));
+            PostingList list;
+            list.count = slots.size();
+            for (size_t from = 0; from < slots.size(); from += BLOCK_SIZE)
+                list.blocks.push_back(encode(slots.data() + from, slots.data() + min(slots.size(), from + BLOCK_SIZE)));
+            terms.emplace(move(names[number]), move(list));
+        }
+    }
+
+    void clear() { terms.clear(); }
+    size_t termCount() const { return terms.size(); }
+
+    // Slots of the tasks containing every word of the query, in slot
+    // order. A word ending in '*' matches any term it is a prefix of.
+    vector<uint32_t> search(string_view query) const {
+        vector<QueryTerm> parts;
+        string text;
+        vector<string_view> tokens;
+        size_t start = 0;
+        while (start < query.size()) {
+            size_t end = query.find(' ', start);
+            if (end == string_view::npos) end = query.size();
+            string_view word = query.substr(start, end - start);
+            start = end + 1;
+            bool prefix = !word.empty() && word.back() == '*';
+            splitWords(prefix ? word.substr(0, word.size() - 1) : word, text, tokens);
+            for (size_t i = 0; i < tokens.size(); i++) {
+                string_view token = tokens[i];
+                QueryTerm part;
+                // In a word such as "follow-up*", only the last term is a prefix
+                if (prefix && i + 1 == tokens.size()) {
+                    for (auto it = terms.lower_bound(token);
+                         it != terms.end() && it->first.compare(0, token.size(), token) == 0; ++it)
+                        for (const PostingBlock& block : it->second.blocks) decode(block, part.slots);
+                    sort(part.slots.begin(), part.slots.end());
+                    part.slots.erase(unique(part.slots.begin(), part.slots.end()), part.slots.end());
+                } else {
+                    auto found = terms.find(token);
+                    if (found == terms.end()) return {};
+                    part.list = &found->second;
+                }
+                if (part.size() == 0) return {};
+                parts.push_back(move(part));
+            }
+        }
+        if (parts.empty()) return {};
+
+        // Start from the rarest word so every later step has less to check
+        sort(parts.begin(), parts.end(), [](const QueryTerm& a, const QueryTerm& b) { return a.size() < b.size(); });
+        vector<uint32_t> result = parts[0].list ? decodeAll(*parts[0].list) : move(parts[0].slots);
+        for (size_t i = 1; i < parts.size() && !result.empty(); i++) {
+            if (parts[i].list) {
+                intersect(result, *parts[i].list);
+            } else {
+                vector<uint32_t> both;
+                set_intersection(result.begin(), result.end(), parts[i].slots.begin(), parts[i].slots.end(),
+                                 back_inserter(both));
+                result.swap(both);
             }
-        } while (choice != 5);  // Exit loop on choice 5
+        }
+        return result;
     }
 };
 
-// Main function
-int main() {
+// Orders pending tasks for the agenda. An indexed binary min-heap keyed
+// by (priority, due day, slot) gives the most urgent tasks, and an ordered
+// tree of (due day, slot) gives tasks by due date, so "next N due" and
+// "overdue" cost O(log n + N). Each slot's heap position is kept, so a
+// task that is completed or removed leaves both in O(log n).
+class TaskScheduler {
+private:
+    struct Entry {
+        uint8_t priority;
+        int32_t dueDay;
+        uint32_t slot;
+
+        bool operator<(const Entry& other) const {
+            if (priority != other.priority) return priority < other.priority;
+            if (dueDay != other.dueDay) return dueDay < other.dueDay;
+            return slot < other.slot;
+        }
+    };
+
+    vector<Entry> heap;
+    vector<uint32_t> positions;            // Heap index by slot, or NONE
+    set<pair<int32_t, uint32_t>> byDueDay; // Only tasks that have a due date
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    void place(size_t index, const Entry& entry) {
+        heap[index] = entry;
+        positions[entry.slot] = static_cast<uint32_t>(index);
+    }
+
+    void siftUp(size_t index) {
+        Entry entry = heap[index];
+        while (index > 0 && entry < heap[(index - 1) / 2]) {
+            place(index, heap[(index - 1) / 2]);
+            index = (index - 1) / 2;
+        }
+        place(index, entry);
+    }
+
+    void siftDown(size_t index) {
+        Entry entry = heap[index];
+        while (true) {
+            size_t child = 2 * index + 1;
+            if (child >= heap.size()) break;
+            if (child + 1 < heap.size() && heap[child + 1] < heap[child]) child++;
+            if (!(heap[child] < entry)) break;
+            place(index, heap[child]);
+            index = child;
+        }
+        place(index, entry);
+    }
+
+public:
+    bool contains(uint32_t slot) const { return slot < positions.size() && positions[slot] != NONE; }
+    size_t size() const { return heap.size(); }
+
+    // Adds a pending task, or updates its schedule if it is already here
+    void add(uint32_t slot, TaskSchedule schedule) {
+        remove(slot);
+        if (slot >= positions.size()) positions.resize(size_t(slot) + 1, NONE);
+        heap.push_back(Entry{schedule.priority, schedule.dueDay, slot});
+        positions[slot] = static_cast<uint32_t>(heap.size() - 1);
+        siftUp(heap.size() - 1);
+        if (schedule.hasDueDate()) byDueDay.emplace(schedule.dueDay, slot);
+    }
+
+    // Drops a task that was completed or removed; does nothing if it is not here
+    void remove(uint32_t slot) {
+        if (!contains(slot)) return;
+        size_t index = positions[slot];
+        Entry entry = heap[index];
+        positions[slot] = NONE;
+        Entry last = heap.back();
+        heap.pop_back();
+        if (index < heap.size()) {
+            place(index, last);
+            if (index > 0 && last < heap[(index - 1) / 2]) siftUp(index);
+            else siftDown(index);
+        }
+        if (entry.dueDay != TaskSchedule::NO_DUE_DATE) byDueDay.erase({entry.dueDay, slot});
+    }
+
+    // Indexes every pending task at once; the heap is built bottom-up in O(n)
+    void build(const TaskSlotMap& tasks) {
+        heap.clear();
+        byDueDay.clear();
+        positions.assign(tasks.slotCount(), NONE);
+        vector<pair<int32_t, uint32_t>> dated;
+        tasks.forEach([&](TaskId id, string_view, bool completed) {
+            if (completed) return;
+            const TaskSchedule& schedule = tasks.schedule(id);
+            heap.push_back(Entry{schedule.priority, schedule.dueDay, id.slot});
+            if (schedule.hasDueDate()) dated.emplace_back(schedule.dueDay, id.slot);
+        });
+        for (size_t i = 0; i < heap.size(); i++) positions[heap[i].slot] = static_cast<uint32_t>(i);
+        for (size_t i = heap.size() / 2; i-- > 0;) siftDown(i);
+        // Inserting in order lets each insert start from the end of the tree
+        sort(dated.begin(), dated.end());
+        for (const auto& task : dated) byDueDay.emplace_hint(byDueDay.end(), task);
+    }
+
+    // The n most urgent tasks, in order, by walking the top of the heap
+    vector<uint32_t> mostUrgent(size_t n) const {
+        vector<uint32_t> slots;
+        auto later = [this](size_t a, size_t b) { return heap[b] < heap[a]; };
+        priority_queue<size_t, vector<size_t>, decltype(later)> frontier(later);
+        if (!heap.empty()) frontier.push(0);
+        while (!frontier.empty() && slots.size() < n) {
+            size_t index = frontier.top();
+            frontier.pop();
+            slots.push_back(heap[index].slot);
+            for (size_t child = 2 * index + 1; child <= 2 * index + 2 && child < heap.size(); child++) frontier.push(child);
+        }
+        return slots;
+    }
+
+    // Up to n tasks due on or after fromDay, soonest first
+    vector<uint32_t> dueFrom(int32_t fromDay, size_t n) const {
+        vector<uint32_t> slots;
+        for (auto it = byDueDay.lower_bound({fromDay, 0}); it != byDueDay.end() && slots.size() < n; ++it)
+            slots.push_back(it->second);
+        return slots;
+    }
+
+    // Up to n tasks due before today, most overdue first
+    vector<uint32_t> overdue(int32_t today, size_t n) const {
+        vector<uint32_t> slots;
+        for (auto it = byDueDay.begin(); it != byDueDay.end() && it->first < today && slots.size() < n; ++it)
+            slots.push_back(it->second);
+        return slots;
+    }
+};
+
+// Appends a task as shown in lists, e.g.
+// "7. Pay rent [Pending, priority 1, due 2026-10-20]\n"
+void appendTaskLine(string& out, const TaskSlotMap& tasks, TaskId id) {
+    out += to_string(id.number());
+    out += ". ";
+    out += tasks.description(id);
+    if (tasks.isCompleted(id)) {
+        out += " [Completed]\n";
+        return;
+    }
+    const TaskSchedule& schedule = tasks.schedule(id);
+    out += " [Pending";
+    if (schedule.priority != TaskSchedule::DEFAULT_PRIORITY) out += ", priority " + to_string(schedule.priority);
+    if (schedule.hasDueDate()) out += ", due " + formatDay(schedule.dueDay);
+    out += "]\n";
+}
+
+// Fenwick (binary indexed) tree of counts: point updates, prefix sums and
+// appending are O(log n)
+class FenwickTree {
+private:
+    vector<int32_t> tree; // 1-based; node i holds the sum of (i - lowBit(i), i]
+
+    static size_t lowBit(size_t i) { return i & (~i + 1); }
+
+public:
+    FenwickTree() : tree(1, 0) {}
+
+    size_t size() const { return tree.size() - 1; }
+    void clear() { tree.assign(1, 0); }
+
+    void push_back(int32_t value) {
+        size_t i = tree.size();
+        int32_t sum = value;
+        for (size_t j = i - 1, stop = i - lowBit(i); j > stop; j -= lowBit(j)) sum += tree[j];
+        tree.push_back(sum);
+    }
+
+    void add(size_t index, int32_t delta) {
+        for (size_t i = index + 1; i < tree.size(); i += lowBit(i)) tree[i] += delta;
+    }
+
+    int64_t prefix(size_t count) const {
+        int64_t sum = 0;
+        for (size_t i = count; i > 0; i -= lowBit(i)) sum += tree[i];
+        return sum;
+    }
+
+    // Raw node, for searching several trees together
+    int32_t node(size_t i) const { return tree[i]; }
+};
+
+// A page at a time of the list in display order, optionally only pending
+// or completed tasks. Every task ever shown gets the next sequence number;
+// Fenwick trees count which sequence numbers are still on the list and
+// still pending, so the k-th task of any filter is found in O(log n)
+// without walking the list. Rendered rows are cached and dropped only
+// when that task changes.
+class TaskListView {
+public:
+    static const size_t PAGE_SIZE = 20;
+
+private:
+    static const size_t MAX_CACHED_LINES = 4096;
+
+    vector<uint32_t> order;       // Slot by sequence number
+    vector<uint32_t> sequenceOf;  // Sequence number by slot
+    FenwickTree present;          // 1 per sequence number still on the list
+    FenwickTree pending;          // 1 per sequence number still pending
+    size_t live = 0;
+    size_t pendingCount = 0;
+    unordered_map<uint32_t, string> lines; // Rendered rows by slot
+
+    int64_t weight(TaskFilter filter, size_t node) const {
+        if (filter == TaskFilter::All) return present.node(node);
+        if (filter == TaskFilter::Pending) return pending.node(node);
+        return present.node(node) - pending.node(node);
+    }
+
+    // Sequence number of the k-th task (from 0) that passes filter; k
+    // must be below count(filter)
+    size_t find(TaskFilter filter, size_t k) const {
+        size_t position = 0;
+        size_t step = 1;
+        while (step * 2 <= present.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            size_t next = position + step;
+            if (next > present.size()) continue;
+            int64_t inside = weight(filter, next);
+            if (inside <= int64_t(k)) {
+                position = next;
+                k -= static_cast<size_t>(inside);
+            }
+        }
+        return position;
+    }
+
+public:
+    void build(const TaskSlotMap& tasks) {
+        order.clear();
+        sequenceOf.assign(tasks.slotCount(), 0);
+        present.clear();
+        pending.clear();
+        lines.clear();
+        live = pendingCount = 0;
+        tasks.forEach([this](TaskId id, string_view, bool completed) { added(id.slot, completed); });
+    }
+
+    void added(uint32_t slot, bool completed) {
+        if (slot >= sequenceOf.size()) sequenceOf.resize(size_t(slot) + 1, 0);
+        sequenceOf[slot] = static_cast<uint32_t>(order.size());
+        order.push_back(slot);
+        present.push_back(1);
+        pending.push_back(completed ? 0 : 1);
+        live++;
+        pendingCount += !completed;
+        lines.erase(slot);
+    }
+
+    void completed(uint32_t slot) {
+        pending.add(sequenceOf[slot], -1);
+        pendingCount--;
+        lines.erase(slot);
+    }
+
+    void reopened(uint32_t slot) {
+        pending.add(sequenceOf[slot], 1);
+        pendingCount++;
+        lines.erase(slot);
+    }
+
+    // The task's row needs rendering again
+    void changed(uint32_t slot) { lines.erase(slot); }
+
+    void removed(uint32_t slot, bool wasCompleted) {
+        present.add(sequenceOf[slot], -1);
+        if (!wasCompleted) {
+            pending.add(sequenceOf[slot], -1);
+            pendingCount--;
+        }
+        live--;
+        lines.erase(slot);
+    }
+
+    // True once removed tasks take up most of the sequence numbers
+    bool wantsRebuild() const { return order.size() > 1024 && live * 2 < order.size(); }
+
+    size_t count(TaskFilter filter) const {
+        return filter == TaskFilter::All ? live : filter == TaskFilter::Pending ? pendingCount : live - pendingCount;
+    }
+
+    // Appends rows first .. first + rows - 1 of the tasks passing filter
+    void render(const TaskSlotMap& tasks, TaskFilter filter, size_t first, size_t rows, string& out) {
+        if (lines.size() > MAX_CACHED_LINES) lines.clear();
+        size_t last = min(count(filter), first + rows);
+        for (size_t k = first; k < last; k++) {
+            uint32_t slot = order[find(filter, k)];
+            auto cached = lines.find(slot);
+            if (cached == lines.end()) {
+                string line;
+                appendTaskLine(line, tasks, tasks.idOfSlot(slot));
+                cached = lines.emplace(slot, move(line)).first;
+            }
+            out += cached->second;
+        }
+    }
+};
+
+// Undo history of the list as persistent versions. A version is a trie
+// over slots, FANOUT children per node, holding the state of every slot
+// changed since the history began (slots never changed are the same in
+// every version and are not stored). A step copies only the nodes on the
+// paths to the slots it changed and shares the rest with the version
+// before, so it costs O(log n) time and memory, old versions stay intact,
+// and moving the list between two versions only visits the subtrees they
+// do not share: O(log n) per task that differs.
+class TaskHistory {
+public:
+    // A slot as of some version
+    struct TaskState {
+        TaskId id;                    // For an empty slot, the generation its next task gets
+        bool occupied = false;
+        bool completed = false;
+        TaskSchedule schedule;
+        TaskId successor{TaskSlotMap::NONE, 0}; // The task after it in display order
+        string description;
+    };
+
+    enum class Change { Removed, Restored, Updated };
+
+private:
+    static const unsigned BITS = 4;
+    static const size_t FANOUT = 1 << BITS;
+
+    // Children are Nodes, or TaskStates on the bottom level
+    struct Node {
+        shared_ptr<const void> children[FANOUT];
+    };
+
+    struct Version {
+        shared_ptr<const void> root;
+        unsigned levels = 1;
+        string label;
+    };
+
+    vector<Version> versions{Version{nullptr, 1, "Start"}};  // Undone versions stay until the next step
+    size_t current = 0;
+    unordered_map<uint32_t, shared_ptr<const TaskState>> original; // Slots as the history began, once changed
+    vector<uint32_t> touched;    // Slots the step being made changes
+
+    static bool fits(uint32_t slot, unsigned levels) { return uint64_t(slot) >> (levels * BITS) == 0; }
+
+    static shared_ptr<const TaskState> stateOf(const TaskSlotMap& tasks, uint32_t slot) {
+        auto state = make_shared<TaskState>();
+        state->id = TaskId{slot, slot < tasks.slotCount() ? tasks.generationOf(slot) : 0};
+        if (tasks.isOccupied(slot)) {
+            state->occupied = true;
+            state->completed = tasks.isCompleted(state->id);
+            state->schedule = tasks.schedule(state->id);
+            uint32_t after = tasks.slotAfter(slot);
+            if (after != TaskSlotMap::NONE) state->successor = tasks.idOfSlot(after);
+            state->description = string(tasks.description(state->id));
+        }
+        return state;
+    }
+
+    // node with slot set to state, copying the path down to it
+    static shared_ptr<const void> with(const shared_ptr<const void>& node, unsigned level, uint32_t slot,
+                                       shared_ptr<const TaskState> state) {
+        auto copy = node ? make_shared<Node>(*static_cast<const Node*>(node.get())) : make_shared<Node>();
+        size_t child = slot >> (level * BITS) & (FANOUT - 1);
+        if (level == 0) copy->children[child] = move(state);
+        else copy->children[child] = with(copy->children[child], level - 1, slot, move(state));
+        return copy;
+    }
+
+    // The version's root lifted to levels, for comparing with a taller version
+    static shared_ptr<const void> rootAt(const Version& version, unsigned levels) {
+        shared_ptr<const void> root = version.root;
+        for (unsigned level = version.levels; level < levels && root; level++) {
+            auto parent = make_shared<Node>();
+            parent->children[0] = move(root);
+            root = move(parent);
+        }
+        return root;
+    }
+
+    static void differences(const void* a, const void* b, unsigned level, uint32_t base, vector<uint32_t>& slots) {
+        for (size_t i = 0; i < FANOUT; i++) {
+            const void* childA = a ? static_cast<const Node*>(a)->children[i].get() : nullptr;
+            const void* childB = b ? static_cast<const Node*>(b)->children[i].get() : nullptr;
+            if (childA == childB) continue;
+            uint32_t slot = base | static_cast<uint32_t>(i) << (level * BITS);
+            if (level == 0) slots.push_back(slot);
+            else differences(childA, childB, level - 1, slot, slots);
+        }
+    }
+
+    // The slot as of version; only for slots changed since the history began
+    const TaskState& stateAt(size_t version, uint32_t slot) const {
+        const Version& v = versions[version];
+        const void* node = fits(slot, v.levels) ? v.root.get() : nullptr;
+        for (unsigned level = v.levels; node && level-- > 0;)
+            node = static_cast<const Node*>(node)->children[slot >> (level * BITS) & (FANOUT - 1)].get();
+        return node ? *static_cast<const TaskState*>(node) : *original.at(slot);
+    }
+
+public:
+    size_t size() const { return versions.size(); }
+    size_t position() const { return current; }
+    const string& label(size_t version) const { return versions[version].label; }
+
+    // Forgets every step; the list as it is becomes the start
+    void clear() {
+        versions.assign(1, Version{nullptr, 1, "Start"});
+        current = 0;
+        original.clear();
+        touched.clear();
+    }
+
+    // Call before a step changes an occupied slot
+    void touch(const TaskSlotMap& tasks, uint32_t slot) {
+        if (original.find(slot) == original.end()) original.emplace(slot, stateOf(tasks, slot));
+        touched.push_back(slot);
+    }
+
+    // Call after a step adds a task
+    void touchAdded(TaskId id) {
+        if (original.find(id.slot) == original.end()) {
+            auto empty = make_shared<TaskState>();
+            empty->id = id;
+            original.emplace(id.slot, move(empty));
+        }
+        touched.push_back(id.slot);
+    }
+
+    // Ends a step: a new version with the touched slots as they are now.
+    // Versions that were undone are dropped.
+    void commit(const TaskSlotMap& tasks, string label) {
+        versions.resize(current + 1);
+        Version version = versions[current];
+        version.label = move(label);
+        for (uint32_t slot : touched) {
+            while (!fits(slot, version.levels)) {
+                version.root = rootAt(version, version.levels + 1);
+                version.levels++;
+            }
+            version.root = with(version.root, version.levels - 1, slot, stateOf(tasks, slot));
+        }
+        touched.clear();
+        versions.push_back(move(version));
+        current++;
+    }
+
+    // Changes tasks to how it was at version, calling observe(change,
+    // before, after) for each task removed, restored or updated
+    template <typename Observe>
+    void moveTo(TaskSlotMap& tasks, size_t version, Observe observe) {
+        if (version >= versions.size() || version == current) return;
+        unsigned levels = max(versions[current].levels, versions[version].levels);
+        vector<uint32_t> slots;
+        differences(rootAt(versions[current], levels).get(), rootAt(versions[version], levels).get(), levels - 1, 0,
+                    slots);
+
+        // Removals and updates first, so restored tasks find their slots free
+        vector<const TaskState*> restores;
+        for (uint32_t slot : slots) {
+            const TaskState& from = stateAt(current, slot);
+            const TaskState& to = stateAt(version, slot);
+            bool sameTask = from.occupied && to.occupied && from.id.generation == to.id.generation;
+            if (sameTask) {
+                if (from.completed == to.completed && from.schedule.priority == to.schedule.priority &&
+                    from.schedule.dueDay == to.schedule.dueDay)
+                    continue;
+                if (to.completed) tasks.markCompleted(to.id);
+                else tasks.markPending(to.id);
+                tasks.setSchedule(to.id, to.schedule);
+                observe(Change::Updated, from, to);
+                continue;
+            }
+            if (from.occupied) {
+                tasks.remove(from.id);
+                observe(Change::Removed, from, to);
+            }
+            if (to.occupied) restores.push_back(&to);
+        }
+
+        // A task goes back before its successor, so a successor that is
+        // coming back too has to be restored first
+        unordered_map<uint64_t, size_t> waiting;
+        for (size_t i = 0; i < restores.size(); i++) waiting.emplace(restores[i]->id.number(), i);
+        vector<char> mark(restores.size(), 0); // 1 while in the chain being restored, 2 once restored
+        vector<size_t> chain;
+        for (size_t i = 0; i < restores.size(); i++) {
+            for (size_t j = i; mark[j] == 0;) {
+                mark[j] = 1;
+                chain.push_back(j);
+                auto successor = waiting.find(restores[j]->successor.number());
+                if (successor == waiting.end()) break;
+                j = successor->second;
+            }
+            for (; !chain.empty(); chain.pop_back()) {
+                const TaskState& to = *restores[chain.back()];
+                tasks.restoreAt(to.id, to.description, to.completed, to.successor);
+                tasks.setSchedule(to.id, to.schedule);
+                mark[chain.back()] = 2;
+                observe(Change::Restored, stateAt(current, to.id.slot), to);
+            }
+        }
+        current = version;
+    }
+};
+
+// CRC-32 (IEEE) lookup tables for slicing-by-8, built at compile time.
+// values[0] is the usual byte table; values[k] advances a byte through k
+// more zero bytes, so eight bytes can be folded in per step.
+struct Crc32Table {
+    uint32_t values[8][256];
+};
+
+constexpr Crc32Table buildCrc32Table() {
+    Crc32Table table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320u : 0);
+        table.values[0][i] = crc;
+    }
+    for (int slice = 1; slice < 8; slice++)
+        for (int i = 0; i < 256; i++) {
+            uint32_t previous = table.values[slice - 1][i];
+            table.values[slice][i] = (previous >> 8) ^ table.values[0][previous & 0xFF];
+        }
+    return table;
+}
+
+constexpr Crc32Table CRC32_TABLE = buildCrc32Table();
+
+// Checksum used to spot records that a crash left half-written
+uint32_t crc32(const char* data, size_t size, uint32_t crc = 0) {
+    const auto& t = CRC32_TABLE.values;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (; size >= 8; size -= 8, p += 8) {
+        uint32_t low = crc ^ (uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; size > 0; size--, p++)
+        crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Little-endian fields for the log and snapshot files
+void putU32(vector<char>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+void putU64(vector<char>& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+uint32_t getU32(const char* p) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= uint32_t(static_cast<uint8_t>(p[i])) << (8 * i);
+    return value;
+}
+
+uint64_t getU64(const char* p) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value |= uint64_t(static_cast<uint8_t>(p[i])) << (8 * i);
+    return value;
+}
+
+// Flushes the file's buffer and asks the OS to put it on disk
+bool syncFile(FILE* file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Syncs the directory holding path, so a file created or renamed there is
+// still there after a crash. Windows has no such call; it is a no-op there.
+bool syncDirectory(const string& path) {
+#ifdef _WIN32
+    (void)path;
+    return true;
+#else
+    size_t slash = path.rfind('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+// Makes a new, empty directory in the temporary directory for a
+// benchmark's files, so it never touches files of the user's; empty if it
+// cannot
+string makeScratchDirectory() {
+#ifdef _WIN32
+    char* name = _tempnam(nullptr, "todo_bench");
+    string path = name ? name : "";
+    free(name);
+    return !path.empty() && _mkdir(path.c_str()) == 0 ? path : "";
+#else
+    const char* base = getenv("TMPDIR");
+    string pattern = string(base && *base ? base : "/tmp") + "/todo_bench.XXXXXX";
+    return mkdtemp(&pattern[0]) ? pattern : "";
+#endif
+}
+
+// Removes a scratch directory once the files in it are gone
+void removeScratchDirectory(const string& path) {
+#ifdef _WIN32
+    _rmdir(path.c_str());
+#else
+    rmdir(path.c_str());
+#endif
+}
+
+// Reads a whole file; false if it cannot be opened
+bool readFile(const string& path, vector<char>& contents) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    contents.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t got = contents.empty() ? 0 : fread(contents.data(), 1, contents.size(), file);
+    fclose(file);
+    contents.resize(got);
+    return true;
+}
+
+// Moves from over to, replacing to, and syncs the directory so the move
+// is on disk before anything relies on it
+bool replaceFile(const string& from, const string& to) {
+#ifdef _WIN32
+    remove(to.c_str()); // rename() will not overwrite on Windows
+#endif
+    return rename(from.c_str(), to.c_str()) == 0 && syncDirectory(to);
+}
+
+// Kinds of change kept in the log
+enum class LogOp : uint8_t {
+    AddTask = 1,      // Payload: task ID number (u64), then the description
+    CompleteTask = 2, // Payload: task ID number (u64)
+    RemoveTask = 3,   // Payload: task ID number (u64)
+    ScheduleTask = 4, // Payload: task ID number (u64), priority (u8), due day (i32)
+    ReopenTask = 5,   // Payload: task ID number (u64)
+    RestoreTask = 6,  // Payload: task ID number (u64), ID number of the task it goes before (u64, 0 for
+                      // the end), completed (u8), priority (u8), due day (i32), then the description
+};
+
+// Append-only log of changes to the list, split into numbered segment
+// files. Callers add records to a shared buffer and one background thread
+// writes out whatever has built up and syncs it with a single fsync, so
+// changes made close together share one disk flush (group commit).
+// Each record is [payload length u32][CRC-32 u32][op u8][payload].
+class WriteAheadLog {
+private:
+    static const size_t RECORD_HEADER = 9;
+
+    string prefix;
+    FILE* file = nullptr;
+    uint64_t segment = 0;
+    uint64_t segmentBytes = 0;    // Bytes appended to the current segment
+    mutex fileLock;               // Held while writing to or switching the file; taken before lock
+    mutex lock;                   // Guards everything below
+    condition_variable hasWork;
+    condition_variable hasSynced;
+    vector<char> pending;         // Records not written yet
+    uint64_t appended = 0;        // Records handed to append()
+    uint64_t synced = 0;          // Records known to be on disk
+    uint64_t syncs = 0;           // fsync calls made
+    bool failed = false;
+    bool stopping = false;
+    thread flusher;
+
+    // Writes out pending records until close() is called. fileLock is not
+    // held while idle, or rotate() could never take it.
+    void flushLoop() {
+        vector<char> batch;
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                hasWork.wait(guard, [&] { return stopping || !pending.empty(); });
+                if (pending.empty()) return;
+            }
+            lock_guard<mutex> fileGuard(fileLock);
+            uint64_t upTo;
+            {
+                lock_guard<mutex> guard(lock);
+                if (pending.empty()) continue; // rotate() wrote it out first
+                batch.swap(pending);
+                upTo = appended;
+            }
+            bool ok = fwrite(batch.data(), 1, batch.size(), file) == batch.size() && syncFile(file);
+            batch.clear();
+            {
+                lock_guard<mutex> guard(lock);
+                failed |= !ok;
+                synced = upTo;
+                syncs++;
+            }
+            hasSynced.notify_all();
+        }
+    }
+
+public:
+    WriteAheadLog() = default;
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog() { close(); }
+
+    static string segmentPath(const string& prefix, uint64_t number) {
+        return prefix + ".wal." + to_string(number);
+    }
+
+    // Starts writing to segment number, which must not exist yet
+    bool open(const string& path, uint64_t number) {
+        close();
+        prefix = path;
+        segment = number;
+        segmentBytes = 0;
+        file = fopen(segmentPath(prefix, segment).c_str(), "wbx");
+        if (!file) return false;
+        if (!syncDirectory(segmentPath(prefix, segment))) {
+            fclose(file);
+            file = nullptr;
+            return false;
+        }
+        appended = synced = syncs = 0;
+        failed = stopping = false;
+        flusher = thread(&WriteAheadLog::flushLoop, this);
+        return true;
+    }
+
+    // Writes and syncs anything pending, then stops the flusher
+    void close() {
+        if (!file) return;
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        hasWork.notify_one();
+        flusher.join();
+        fclose(file);
+        file = nullptr;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Queues a record and returns its ticket for waitDurable(). The payload
+    // is head followed by body, so callers need not join them first.
+    uint64_t append(LogOp op, const char* head, size_t headSize, const char* body = nullptr, size_t bodySize = 0) {
+        size_t size = headSize + bodySize;
+        lock_guard<mutex> guard(lock);
+        size_t start = pending.size();
+        putU32(pending, static_cast<uint32_t>(size));
+        putU32(pending, 0);
+        pending.push_back(static_cast<char>(op));
+        pending.insert(pending.end(), head, head + headSize);
+        if (bodySize) pending.insert(pending.end(), body, body + bodySize);
+        uint32_t crc = crc32(pending.data() + start + 8, size + 1);
+        for (int i = 0; i < 4; i++) pending[start + 4 + i] = static_cast<char>(crc >> (8 * i));
+        segmentBytes += RECORD_HEADER + size;
+        if (pending.size() == RECORD_HEADER + size) hasWork.notify_one();
+        return ++appended;
+    }
+
+    // Waits until the record with this ticket is on disk; false if a write failed
+    bool waitDurable(uint64_t ticket) {
+        unique_lock<mutex> guard(lock);
+        hasSynced.wait(guard, [&] { return synced >= ticket || failed; });
+        return !failed;
+    }
+
+    // Waits until everything appended so far is on disk
+    bool sync() {
+        uint64_t ticket;
+        {
+            lock_guard<mutex> guard(lock);
+            ticket = appended;
+        }
+        return waitDurable(ticket);
+    }
+
+    // Finishes the current segment and starts the next one. Everything
+    // appended before the call is in the old segment (and on disk); all
+    // later records go to the new one, whose number is returned.
+    uint64_t rotate() {
+        lock_guard<mutex> fileGuard(fileLock);
+        lock_guard<mutex> guard(lock);
+        bool ok = fwrite(pending.data(), 1, pending.size(), file) == pending.size() && syncFile(file);
+        pending.clear();
+        fclose(file);
+        // "x": never truncate a segment that is already there
+        file = fopen(segmentPath(prefix, ++segment).c_str(), "wbx");
+        // The new segment's directory entry has to be on disk before the
+        // snapshot lets the old segments go
+        failed |= !ok || !file || !syncDirectory(segmentPath(prefix, segment));
+        synced = appended;
+        segmentBytes = 0;
+        hasSynced.notify_all();
+        return segment;
+    }
+
+    uint64_t getSegment() const { return segment; }
+    uint64_t getSyncCount() {
+        lock_guard<mutex> guard(lock);
+        return syncs;
+    }
+    uint64_t getSegmentBytes() {
+        lock_guard<mutex> guard(lock);
+        return segmentBytes;
+    }
+
+    // Calls apply(op, payload, size) for every intact record in segments
+    // first, first + 1, ... until one is missing. A segment stops at its
+    // first damaged record, which can only be a crash's torn tail since a
+    // segment is never appended to again after a restart. Returns the
+    // number of the first missing segment and adds the bytes read to bytes.
+    template <typename Apply>
+    static uint64_t replay(const string& prefix, uint64_t first, Apply apply, uint64_t& bytes) {
+        vector<char> contents;
+        uint64_t number = first;
+        for (; readFile(segmentPath(prefix, number), contents); number++) {
+            bytes += contents.size();
+            size_t offset = 0;
+            while (offset + RECORD_HEADER <= contents.size()) {
+                const char* record = contents.data() + offset;
+                uint32_t size = getU32(record);
+                if (offset + RECORD_HEADER + size > contents.size() || crc32(record + 8, size + 1) != getU32(record + 4))
+                    break;
+                apply(static_cast<LogOp>(record[8]), record + RECORD_HEADER, size);
+                offset += RECORD_HEADER + size;
+            }
+        }
+        return number;
+    }
+};
+
+// A whole file, read only: mapped into memory where mmap is available,
+// otherwise read in
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    vector<char> contents;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const string& path) {
+        close();
+#ifdef _WIN32
+        if (!readFile(path, contents)) return false;
+        bytes = contents.data();
+        length = contents.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat status;
+        bool ok = fstat(fd, &status) == 0;
+        length = ok ? static_cast<size_t>(status.st_size) : 0;
+        if (ok && length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            ok = mapped != MAP_FAILED;
+            if (ok) {
+                bytes = static_cast<const char*>(mapped);
+                madvise(mapped, length, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        if (!ok) length = 0;
+        return ok;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        contents.clear();
+#else
+        if (bytes) munmap(const_cast<char*>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// The whole list at one moment, plus the first log segment that is not
+// already part of it: "TODOSNAP", version u32 (1), reserved u32, first
+// segment u64, task count u64, slot count u64, then every slot's
+// generation (u32 each), then per task in display order [slot u32]
+// [completed u8][priority u8][due day i32][length u32][description], and
+// a CRC-32 of all of that at the end.
+class TaskSnapshot {
+    static constexpr size_t TASK_BYTES = 14; // Per task before its description
+
+public:
+    static string path(const string& prefix) { return prefix + ".snapshot"; }
+
+    // Writes a temporary file, syncs it and renames it into place, so a
+    // crash leaves either the old snapshot or the new one
+    static bool write(const string& prefix, const TaskSlotMap& tasks, uint64_t firstSegment) {
+        string temporary = path(prefix) + ".tmp";
+        FILE* file = fopen(temporary.c_str(), "wb");
+        if (!file) return false;
+
+        vector<char> buffer;
+        buffer.reserve(1 << 20);
+        uint32_t crc = 0;
+        bool ok = true;
+        auto flush = [&] {
+            crc = crc32(buffer.data(), buffer.size(), crc);
+            ok &= fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            buffer.clear();
+        };
+
+        buffer.insert(buffer.end(), "TODOSNAP", "TODOSNAP" + 8);
+        putU32(buffer, 1);
+        putU32(buffer, 0);
+        putU64(buffer, firstSegment);
+        putU64(buffer, tasks.size());
+        putU64(buffer, tasks.slotCount());
+        for (uint32_t slot = 0; slot < tasks.slotCount(); slot++) {
+            putU32(buffer, tasks.generationOf(slot));
+            if (buffer.size() >= (1 << 20)) flush();
+        }
+        tasks.forEach([&](TaskId id, string_view description, bool completed) {
+            const TaskSchedule& schedule = tasks.schedule(id);
+            putU32(buffer, id.slot);
+            buffer.push_back(completed ? 1 : 0);
+            buffer.push_back(static_cast<char>(schedule.priority));
+            putU32(buffer, static_cast<uint32_t>(schedule.dueDay));
+            putU32(buffer, static_cast<uint32_t>(description.size()));
+            buffer.insert(buffer.end(), description.begin(), description.end());
+            if (buffer.size() >= (1 << 20)) flush();
+        });
+        flush();
+        putU32(buffer, crc);
+        ok &= fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        ok &= syncFile(file);
+        ok &= fclose(file) == 0;
+        return ok && replaceFile(temporary, path(prefix));
+    }
+
+    // Loads the snapshot if there is one. Returns false only if it exists
+    // but is damaged; with no snapshot, tasks stays empty and firstSegment is 1.
+    // The free list of tasks is not rebuilt; the caller does that once any
+    // log has been replayed too.
+    static bool read(const string& prefix, TaskSlotMap& tasks, uint64_t& firstSegment, uint64_t& bytes) {
+        firstSegment = 1;
+        MappedFile contents;
+        if (!contents.open(path(prefix))) return true;
+        bytes = contents.size();
+        if (contents.size() < 44 || memcmp(contents.data(), "TODOSNAP", 8) != 0 ||
+            getU32(contents.data() + 8) != 1 ||
+            crc32(contents.data(), contents.size() - 4) != getU32(contents.data() + contents.size() - 4))
+            return false;
+
+        firstSegment = getU64(contents.data() + 16);
+        uint64_t count = getU64(contents.data() + 24);
+        uint64_t slots = getU64(contents.data() + 32);
+        const char* p = contents.data() + 40;
+        const char* end = contents.data() + contents.size() - 4;
+        // Tasks go straight into presized arrays and one arena block, in
+        // the order they were saved, which is display order
+        if (uint64_t(end - p) / 4 < slots || slots > TaskSlotMap::NONE || count > slots) return false;
+        const char* records = p + slots * 4;
+        uint64_t fixedBytes = count * TASK_BYTES;
+        if (uint64_t(end - records) < fixedBytes) return false;
+        tasks.startLoad(slots, uint64_t(end - records) - fixedBytes);
+        for (uint64_t slot = 0; slot < slots; slot++, p += 4)
+            tasks.setGeneration(static_cast<uint32_t>(slot), getU32(p));
+        for (uint64_t i = 0; i < count; i++) {
+            if (size_t(end - p) < TASK_BYTES) return false;
+            uint32_t slot = getU32(p);
+            bool completed = p[4] != 0;
+            TaskSchedule schedule;
+            schedule.priority = static_cast<uint8_t>(p[5]);
+            schedule.dueDay = static_cast<int32_t>(getU32(p + 6));
+            p += 10;
+            uint32_t length = getU32(p);
+            if (uint64_t(end - p - 4) < length) return false;
+            if (!tasks.load(slot, string_view(p + 4, length), completed, schedule)) return false;
+            p += 4 + length;
+        }
+        return true;
+    }
+};
+
+// Keeps the list on disk: a snapshot plus a log of the changes made since.
+// Opening loads the snapshot and replays the log. Once the log outgrows
+// the snapshot, a new snapshot is written on a background thread and the
+// log segments it covers are deleted.
+class TaskStorage {
+private:
+    static constexpr uint64_t MIN_COMPACT_BYTES = 4 << 20;
+    static const uint64_t MAX_SEGMENTS = 16; // Every run starts a segment, so short runs add up
+
+    string prefix;
+    WriteAheadLog log;
+    uint64_t firstSegment = 1;      // Oldest segment still needed
+    uint64_t snapshotBytes = 0;
+    uint64_t replayedBytes = 0;     // Log bytes from before this run
+    thread compactor;
+    atomic<bool> compacting{false};
+    int lockFile = -1;              // Held open, and locked, while the list is open
+    bool busy = false;              // The last open() failed because another process has the list
+
+    // Takes <prefix>.lock, so only one process at a time uses the files;
+    // the lock goes when the file is closed, or the process exits
+    bool lock() {
+        string path = prefix + ".lock";
+#ifdef _WIN32
+        if (_sopen_s(&lockFile, path.c_str(), _O_RDWR | _O_CREAT, _SH_DENYRW, _S_IREAD | _S_IWRITE) != 0) {
+            lockFile = -1;
+            busy = errno == EACCES;
+            return false;
+        }
+#else
+        lockFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lockFile < 0) return false;
+        if (flock(lockFile, LOCK_EX | LOCK_NB) != 0) {
+            busy = errno == EWOULDBLOCK;
+            unlock();
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    void unlock() {
+        if (lockFile < 0) return;
+#ifdef _WIN32
+        _close(lockFile);
+#else
+        ::close(lockFile);
+#endif
+        lockFile = -1;
+    }
+
+    static void encodeId(TaskId id, char* out) {
+        uint64_t number = id.number();
+        for (int i = 0; i < 8; i++) out[i] = static_cast<char>(number >> (8 * i));
+    }
+
+    bool appendId(LogOp op, TaskId id, bool wait) {
+        char payload[8];
+        encodeId(id, payload);
+        uint64_t ticket = log.append(op, payload, sizeof(payload));
+        return !wait || log.waitDurable(ticket);
+    }
+
+    // Applies one log record to tasks
+    static void apply(TaskSlotMap& tasks, LogOp op, const char* payload, size_t size) {
+        switch (op) {
+            case LogOp::AddTask:
+                if (size >= 8) tasks.restore(TaskId::fromNumber(getU64(payload)), string_view(payload + 8, size - 8));
+                return;
+            case LogOp::RestoreTask:
+                if (size >= 22) {
+                    TaskId id = TaskId::fromNumber(getU64(payload));
+                    uint64_t before = getU64(payload + 8);
+                    TaskSchedule schedule;
+                    schedule.priority = static_cast<uint8_t>(payload[17]);
+                    schedule.dueDay = static_cast<int32_t>(getU32(payload + 18));
+                    if (tasks.restoreAt(id, string_view(payload + 22, size - 22), payload[16] != 0,
+                                        before ? TaskId::fromNumber(before) : TaskId{TaskSlotMap::NONE, 0}))
+                        tasks.setSchedule(id, schedule);
+                }
+                return;
+            default:
+                break;
+        }
+
+        if (size < 8) return;
+        TaskId id = TaskId::fromNumber(getU64(payload));
+        if (op == LogOp::CompleteTask) {
+            tasks.markCompleted(id);
+        } else if (op == LogOp::ReopenTask) {
+            tasks.markPending(id);
+        } else if (op == LogOp::RemoveTask) {
+            tasks.remove(id);
+        } else if (op == LogOp::ScheduleTask && size >= 13) {
+            TaskSchedule schedule;
+            schedule.priority = static_cast<uint8_t>(payload[8]);
+            schedule.dueDay = static_cast<int32_t>(getU32(payload + 9));
+            tasks.setSchedule(id, schedule);
+        }
+    }
+
+public:
+    TaskStorage() = default;
+    TaskStorage(const TaskStorage&) = delete;
+    TaskStorage& operator=(const TaskStorage&) = delete;
+
+    ~TaskStorage() { close(); }
+
+    // Loads the saved list into tasks and starts a new log segment for this
+    // run; false if the files are damaged or cannot be written
+    bool open(const string& path, TaskSlotMap& tasks) {
+        close();
+        prefix = path;
+        snapshotBytes = replayedBytes = 0;
+        busy = false;
+        if (!lock()) return false;
+        if (!TaskSnapshot::read(prefix, tasks, firstSegment, snapshotBytes)) {
+            unlock();
+            return false;
+        }
+
+        // Records put tasks straight into their slots; the free list is
+        // rebuilt once they are all in
+        uint64_t next = WriteAheadLog::replay(prefix, firstSegment, [&](LogOp op, const char* payload, size_t size) {
+            apply(tasks, op, payload, size);
+        }, replayedBytes);
+        tasks.rebuildFreeList();
+        if (!log.open(prefix, next)) {
+            unlock();
+            return false;
+        }
+        return true;
+    }
+
+    // Waits for a running compaction, closes the log and lets other
+    // processes open the list
+    void close() {
+        if (compactor.joinable()) compactor.join();
+        log.close();
+        unlock();
+    }
+
+    bool isOpen() const { return log.isOpen(); }
+
+    // True if the last open() failed because another process has the list open
+    bool isBusy() const { return busy; }
+
+    // Each change is logged before it is acknowledged and false means it
+    // could not be written; with wait false the caller must check sync()
+    // before relying on it
+    bool recordAdd(TaskId id, const string& description, bool wait = true) {
+        char payload[8];
+        encodeId(id, payload);
+        uint64_t ticket = log.append(LogOp::AddTask, payload, sizeof(payload), description.data(), description.size());
+        return !wait || log.waitDurable(ticket);
+    }
+    bool recordComplete(TaskId id, bool wait = true) { return appendId(LogOp::CompleteTask, id, wait); }
+    bool recordRemove(TaskId id, bool wait = true) { return appendId(LogOp::RemoveTask, id, wait); }
+    bool recordReopen(TaskId id, bool wait = true) { return appendId(LogOp::ReopenTask, id, wait); }
+    bool recordRestore(TaskId id, TaskId before, bool completed, TaskSchedule schedule, string_view description,
+                       bool wait = true) {
+        char payload[22];
+        encodeId(id, payload);
+        if (before.slot == TaskSlotMap::NONE) memset(payload + 8, 0, 8);
+        else encodeId(before, payload + 8);
+        payload[16] = completed ? 1 : 0;
+        payload[17] = static_cast<char>(schedule.priority);
+        for (int i = 0; i < 4; i++) payload[18 + i] = static_cast<char>(static_cast<uint32_t>(schedule.dueDay) >> (8 * i));
+        uint64_t ticket = log.append(LogOp::RestoreTask, payload, sizeof(payload), description.data(), description.size());
+        return !wait || log.waitDurable(ticket);
+    }
+    bool recordSchedule(TaskId id, TaskSchedule schedule, bool wait = true) {
+        char payload[13];
+        encodeId(id, payload);
+        payload[8] = static_cast<char>(schedule.priority);
+        for (int i = 0; i < 4; i++) payload[9 + i] = static_cast<char>(static_cast<uint32_t>(schedule.dueDay) >> (8 * i));
+        uint64_t ticket = log.append(LogOp::ScheduleTask, payload, sizeof(payload));
+        return !wait || log.waitDurable(ticket);
+    }
+    bool sync() { return log.sync(); }
+
+    uint64_t getSyncCount() { return log.getSyncCount(); }
+
+    // Starts a background snapshot once the log since the last one is
+    // bigger than that snapshot. tasks must be the list after every logged
+    // change; it is copied, so the caller can go on changing it.
+    void maybeCompact(const TaskSlotMap& tasks) {
+        if (compacting.load())
+            return;
+        if (replayedBytes + log.getSegmentBytes() < max(MIN_COMPACT_BYTES, snapshotBytes) &&
+            log.getSegment() - firstSegment < MAX_SEGMENTS)
+            return;
+        if (compactor.joinable()) compactor.join();
+        compacting.store(true);
+
+        TaskSlotMap copy(tasks);
+        uint64_t covered = log.rotate(); // The snapshot holds everything before this segment
+        uint64_t obsolete = firstSegment;
+        replayedBytes = 0;
+        compactor = thread([this, copy = move(copy), covered, obsolete]() mutable {
+            if (TaskSnapshot::write(prefix, copy, covered)) {
+                for (uint64_t number = obsolete; number < covered; number++)
+                    remove(WriteAheadLog::segmentPath(prefix, number).c_str());
+                firstSegment = covered;
+                snapshotBytes = 44 + copy.slotCount() * 4 + copy.size() * 14;
+                copy.forEach([&](TaskId, string_view description, bool) { snapshotBytes += description.size(); });
+            }
+            compacting.store(false);
+        });
+    }
+
+    // Writes a snapshot now, on this thread (after imports, and in the
+    // benchmark); false if it could not be written
+    bool compactNow(const TaskSlotMap& tasks) {
+        if (compactor.joinable()) compactor.join();
+        uint64_t covered = log.rotate();
+        if (!TaskSnapshot::write(prefix, tasks, covered)) return false;
+        for (uint64_t number = firstSegment; number < covered; number++)
+            remove(WriteAheadLog::segmentPath(prefix, number).c_str());
+        firstSegment = covered;
+        replayedBytes = 0;
+        snapshotBytes = 44 + tasks.slotCount() * 4 + tasks.size() * 14;
+        tasks.forEach([&](TaskId, string_view description, bool) { snapshotBytes += description.size(); });
+        return true;
+    }
+
+    // Deletes the snapshot and all log segments of prefix
+    static void destroy(const string& prefix) {
+        TaskSlotMap none;
+        uint64_t first, bytes = 0;
+        TaskSnapshot::read(prefix, none, first, bytes);
+        remove(TaskSnapshot::path(prefix).c_str());
+        remove((prefix + ".lock").c_str());
+        for (uint64_t number = 1;; number++) {
+            bool gone = remove(WriteAheadLog::segmentPath(prefix, number).c_str()) != 0;
+            if (gone && number >= first) break;
+        }
+    }
+};
+
+enum class TaskFileFormat { Csv, JsonLines };
+
+// Bulk import and export of tasks, one per line, as CSV
+//   description,status,priority,due
+//   "Buy milk, eggs",pending,2,2026-10-20
+// or as JSON lines
+//   {"description":"Buy milk, eggs","completed":false,"priority":2,"due":"2026-10-20"}
+// Only the description is required; status is pending or completed,
+// priority 1 to 5 (3 if left out) and due a YYYY-MM-DD date or empty/null.
+// Imports map the file, split it at line breaks into one chunk per core,
+// parse the chunks in parallel and then add every task in file order.
+class TaskFile {
+public:
+    struct ImportResult {
+        bool opened = false;
+        size_t added = 0;
+        size_t skipped = 0;         // Lines that could not be read
+        size_t firstSkippedLine = 0; // 1-based; 0 if none were skipped
+    };
+
+private:
+    static constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+    // ParsedTask offsets are 32 bits, and a chunk's text is never longer than the chunk
+    static constexpr size_t MAX_CHUNK_BYTES = UINT32_MAX;
+    static constexpr size_t WRITE_BUFFER = 4 << 20;
+
+    struct ParsedTask {
+        uint32_t offset;  // Of the description in the chunk's text
+        uint32_t length;
+        bool completed;
+        TaskSchedule schedule;
+    };
+
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        string text;  // Descriptions, back to back
+        vector<ParsedTask> tasks;
+        size_t lines = 0;
+        size_t skipped = 0;
+        size_t firstSkippedLine = 0; // Within the chunk, 1-based
+    };
+
+    static bool equalsIgnoringCase(string_view text, const char* word) {
+        size_t i = 0;
+        for (; i < text.size() && word[i]; i++)
+            if ((text[i] >= 'A' && text[i] <= 'Z' ? text[i] + 32 : text[i]) != word[i]) return false;
+        return i == text.size() && !word[i];
+    }
+
+    static bool parseStatus(string_view text, bool& completed) {
+        if (text.empty() || equalsIgnoringCase(text, "pending") || equalsIgnoringCase(text, "false")) {
+            completed = false;
+        } else if (equalsIgnoringCase(text, "completed") || equalsIgnoringCase(text, "true")) {
+            completed = true;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static bool parsePriority(string_view text, uint8_t& priority) {
+        if (text.empty()) {
+            priority = TaskSchedule::DEFAULT_PRIORITY;
+            return true;
+        }
+        if (text.size() != 1 || text[0] < '1' || text[0] > '5') return false;
+        priority = static_cast<uint8_t>(text[0] - '0');
+        return true;
+    }
+
+    static bool parseDue(string_view text, int32_t& dueDay) {
+        if (text.empty()) {
+            dueDay = TaskSchedule::NO_DUE_DATE;
+            return true;
+        }
+        return parseDay(text, dueDay);
+    }
+
+    // Descriptions stay on one line in the list, so line breaks and other
+    // control characters become spaces
+    static void removeControlCharacters(string& text, size_t from) {
+        for (size_t i = from; i < text.size(); i++)
+            if (static_cast<unsigned char>(text[i]) < 0x20) text[i] = ' ';
+    }
+
+    // Reads one CSV field starting at p into out; quoted fields may hold
+    // commas and doubled quotes. Leaves p at the comma or the end.
+    static bool readCsvField(const char*& p, const char* end, string& out) {
+        size_t start = out.size();
+        if (p == end || *p != '"') {
+            const char* comma = static_cast<const char*>(memchr(p, ',', static_cast<size_t>(end - p)));
+            const char* fieldEnd = comma ? comma : end;
+            out.append(p, fieldEnd);
+            p = fieldEnd;
+            removeControlCharacters(out, start);
+            return true;
+        }
+        for (p++; p != end;) {
+            const char* quote = static_cast<const char*>(memchr(p, '"', static_cast<size_t>(end - p)));
+            if (!quote) return false; // No closing quote
+            out.append(p, quote);
+            p = quote + 1;
+            if (p != end && *p == '"') {
+                out += '"';
+                p++;
+            } else {
+                removeControlCharacters(out, start);
+                return p == end || *p == ',';
+            }
+        }
+        return false;
+    }
+
+    static bool parseCsvLine(const char* p, const char* end, string& text, string& field, ParsedTask& task) {
+        size_t start = text.size();
+        if (!readCsvField(p, end, text)) return false;
+        task.offset = static_cast<uint32_t>(start);
+        task.length = static_cast<uint32_t>(text.size() - start);
+        task.completed = false;
+        task.schedule = TaskSchedule();
+        for (int column = 1; p != end; column++) {
+            p++; // The comma
+            field.clear();
+            if (column > 3 || !readCsvField(p, end, field)) return false;
+            bool ok = column == 1 ? parseStatus(field, task.completed)
+                    : column == 2 ? parsePriority(field, task.schedule.priority)
+                    : parseDue(field, task.schedule.dueDay);
+            if (!ok) return false;
+        }
+        return task.length > 0;
+    }
+
+    static void skipSpace(const char*& p, const char* end) {
+        while (p != end && (*p == ' ' || *p == '\t')) p++;
+    }
+
+    static void appendUtf8(string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code < 0x20 ? ' ' : code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    static bool readHex4(const char*& p, const char* end, uint32_t& code) {
+        if (end - p < 4) return false;
+        code = 0;
+        for (int i = 0; i < 4; i++, p++) {
+            char c = *p;
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (digit < 0) return false;
+            code = code * 16 + static_cast<uint32_t>(digit);
+        }
+        return true;
+    }
+
+    // Reads a JSON string at p (on its opening quote) into out
+    static bool readJsonString(const char*& p, const char* end, string& out) {
+        if (p == end || *p != '"') return false;
+        p++;
+        while (p != end) {
+            const char* run = p;
+            while (p != end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20) p++;
+            out.append(run, p);
+            if (p == end || static_cast<unsigned char>(*p) < 0x20) return false;
+            if (*p++ == '"') return true;
+            if (p == end) return false;
+            char escape = *p++;
+            uint32_t code;
+            switch (escape) {
+                case '"': case '\\': case '/': out += escape; break;
+                case 'b': case 'f': case 'n': case 'r': case 't': out += ' '; break;
+                case 'u':
+                    if (!readHex4(p, end, code)) return false;
+                    if (code >= 0xD800 && code < 0xDC00) {
+                        uint32_t low;
+                        if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && (p += 2, readHex4(p, end, low)) &&
+                            low >= 0xDC00 && low < 0xE000)
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        else
+                            code = 0xFFFD;
+                    } else if (code >= 0xDC00 && code < 0xE000) {
+                        code = 0xFFFD;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    // Skips a JSON value this format does not use
+    static bool skipJsonValue(const char*& p, const char* end, string& scratch) {
+        int depth = 0;
+        while (p != end) {
+            if (*p == '"') {
+                scratch.clear();
+                if (!readJsonString(p, end, scratch)) return false;
+                if (depth == 0) return true;
+                continue;
+            }
+            if (*p == '{' || *p == '[') depth++;
+            else if (*p == '}' || *p == ']') {
+                if (depth == 0) return true;
+                if (--depth == 0) {
+                    p++;
+                    return true;
+                }
+            } else if (*p == ',' && depth == 0) {
+                return true;
+            }
+            p++;
+        }
+        return false;
+    }
+
+    static bool readJsonLiteral(const char*& p, const char* end, const char* literal) {
+        size_t length = strlen(literal);
+        if (static_cast<size_t>(end - p) < length || memcmp(p, literal, length) != 0) return false;
+        p += length;
+        return true;
+    }
+
+    static bool parseJsonLine(const char* p, const char* end, string& text, string& field, ParsedTask& task) {
+        task.offset = static_cast<uint32_t>(text.size());
+        task.length = 0;
+        task.completed = false;
+        task.schedule = TaskSchedule();
+        bool described = false;
+        skipSpace(p, end);
+        if (p == end || *p++ != '{') return false;
+        skipSpace(p, end);
+        if (p != end && *p == '}') return false;
+        while (true) {
+            field.clear();
+            skipSpace(p, end);
+            if (!readJsonString(p, end, field)) return false;
+            skipSpace(p, end);
+            if (p == end || *p++ != ':') return false;
+            skipSpace(p, end);
+            bool ok;
+            if (field == "description") {
+                if (described) return false;
+                described = true;
+                size_t start = text.size();
+                ok = readJsonString(p, end, text);
+                removeControlCharacters(text, start);
+                task.offset = static_cast<uint32_t>(start);
+                task.length = static_cast<uint32_t>(text.size() - start);
+            } else if (field == "completed") {
+                ok = readJsonLiteral(p, end, "true") ? (task.completed = true)
+                   : readJsonLiteral(p, end, "false");
+            } else if (field == "priority") {
+                ok = p != end && *p >= '1' && *p <= '5' && (p + 1 == end || !isdigit(static_cast<unsigned char>(p[1])));
+                if (ok) task.schedule.priority = static_cast<uint8_t>(*p++ - '0');
+            } else if (field == "due") {
+                field.clear();
+                ok = readJsonLiteral(p, end, "null") || (readJsonString(p, end, field) && parseDue(field, task.schedule.dueDay));
+            } else {
+                ok = skipJsonValue(p, end, field);
+            }
+            if (!ok) return false;
+            skipSpace(p, end);
+            if (p == end) return false;
+            if (*p == '}') break;
+            if (*p++ != ',') return false;
+        }
+        p++;
+        skipSpace(p, end);
+        return p == end && described && task.length > 0;
+    }
+
+    static void parseChunk(Chunk& chunk, TaskFileFormat format, bool first) {
+        string field;
+        ParsedTask task;
+        for (const char* line = chunk.begin; line < chunk.end;) {
+            const char* lineEnd = static_cast<const char*>(memchr(line, '\n', static_cast<size_t>(chunk.end - line)));
+            if (!lineEnd) lineEnd = chunk.end;
+            const char* next = lineEnd + (lineEnd != chunk.end);
+            if (lineEnd != line && lineEnd[-1] == '\r') lineEnd--;
+            chunk.lines++;
+
+            size_t textSize = chunk.text.size();
+            size_t length = static_cast<size_t>(lineEnd - line);
+            bool header = first && chunk.lines == 1 && format == TaskFileFormat::Csv &&
+                          equalsIgnoringCase(string_view(line, min<size_t>(11, length)), "description") &&
+                          (length == 11 || line[11] == ',');
+            bool blank = lineEnd == line;
+            if (!header && !blank) {
+                bool ok = format == TaskFileFormat::Csv ? parseCsvLine(line, lineEnd, chunk.text, field, task)
+                                                        : parseJsonLine(line, lineEnd, chunk.text, field, task);
+                // Only a line gigabytes long could take the text past what the offsets hold
+                ok &= chunk.text.size() <= UINT32_MAX;
+                if (ok) {
+                    chunk.tasks.push_back(task);
+                } else {
+                    chunk.text.resize(textSize);
+                    if (chunk.skipped++ == 0) chunk.firstSkippedLine = chunk.lines;
+                }
+            }
+            line = next;
+        }
+    }
+
+    // formatDay() without the snprintf, as it is called for every dated task
+    static void appendDay(string& out, int32_t days) {
+        int year;
+        unsigned month, day;
+        civilFromDays(days, year, month, day);
+        if (year < 0 || year > 9999) {
+            out += formatDay(days);
+            return;
+        }
+        char text[10] = {char('0' + year / 1000), char('0' + year / 100 % 10), char('0' + year / 10 % 10),
+                         char('0' + year % 10), '-', char('0' + month / 10), char('0' + month % 10), '-',
+                         char('0' + day / 10), char('0' + day % 10)};
+        out.append(text, sizeof(text));
+    }
+
+    static void appendCsvField(string& out, string_view text) {
+        if (text.find_first_of(",\"") == string_view::npos) {
+            out += text;
+            return;
+        }
+        out += '"';
+        for (size_t from = 0; from < text.size();) {
+            size_t quote = min(text.find('"', from), text.size());
+            out.append(text.data() + from, quote - from);
+            if (quote < text.size()) out += "\"\"";
+            from = quote + 1;
+        }
+        out += '"';
+    }
+
+    static void appendJsonString(string& out, string_view text) {
+        out += '"';
+        size_t plain = 0;
+        while (plain < text.size() && text[plain] != '"' && text[plain] != '\\' &&
+               static_cast<unsigned char>(text[plain]) >= 0x20)
+            plain++;
+        out.append(text.data(), plain);
+        for (char c : text.substr(plain)) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+
+public:
+    // JSON lines for .jsonl, .ndjson and .json files, CSV otherwise
+    static TaskFileFormat formatOf(const string& path) {
+        size_t dot = path.rfind('.');
+        string extension = dot == string::npos ? "" : path.substr(dot + 1);
+        for (char& c : extension) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return extension == "jsonl" || extension == "ndjson" || extension == "json" ? TaskFileFormat::JsonLines
+                                                                                     : TaskFileFormat::Csv;
+    }
+
+    // Adds every task in the file to the end of tasks, using up to threads
+    // threads (0 for one per core). Lines that cannot be read are skipped.
+    static ImportResult import(const string& path, TaskSlotMap& tasks, unsigned threads = 0) {
+        ImportResult result;
+        MappedFile file;
+        if (!file.open(path)) return result;
+        result.opened = true;
+        TaskFileFormat format = formatOf(path);
+
+        // Split at the first line break after each even share of the file;
+        // files over MAX_CHUNK_BYTES per thread get more chunks (and threads)
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        size_t count = max<size_t>(1, min<size_t>(threads, file.size() / MIN_CHUNK_BYTES));
+        count = max(count, (file.size() + MAX_CHUNK_BYTES - 1) / MAX_CHUNK_BYTES);
+        vector<Chunk> chunks(count);
+        const char* end = file.data() + file.size();
+        const char* begin = file.data();
+        for (size_t i = 0; i < count; i++) {
+            const char* split = i + 1 == count ? end : file.data() + file.size() / count * (i + 1);
+            if (split < begin) split = begin;
+            const char* lineBreak = static_cast<const char*>(memchr(split, '\n', static_cast<size_t>(end - split)));
+            split = lineBreak ? lineBreak + 1 : end;
+            chunks[i].begin = begin;
+            chunks[i].end = split;
+            chunks[i].text.reserve(static_cast<size_t>(split - begin));
+            begin = split;
+        }
+
+        vector<thread> workers;
+        for (size_t i = 1; i < count; i++)
+            workers.emplace_back([&chunks, format, i] { parseChunk(chunks[i], format, false); });
+        parseChunk(chunks[0], format, true);
+        for (thread& worker : workers) worker.join();
+
+        size_t total = 0, line = 0;
+        for (Chunk& chunk : chunks) {
+            total += chunk.tasks.size();
+            if (chunk.skipped && result.skipped == 0) result.firstSkippedLine = line + chunk.firstSkippedLine;
+            result.skipped += chunk.skipped;
+            line += chunk.lines;
+        }
+        tasks.reserve(total);
+        for (Chunk& chunk : chunks) {
+            for (const ParsedTask& parsed : chunk.tasks) {
+                TaskId id = tasks.add(string_view(chunk.text.data() + parsed.offset, parsed.length), parsed.completed);
+                if (!parsed.schedule.isDefault()) tasks.setSchedule(id, parsed.schedule);
+            }
+            // Free each chunk as soon as it is in, to keep the peak down
+            string().swap(chunk.text);
+            vector<ParsedTask>().swap(chunk.tasks);
+        }
+        result.added = total;
+        return result;
+    }
+
+    // Writes every task, in list order, through a large buffer; false if
+    // the file could not be written
+    static bool exportTo(const string& path, const TaskSlotMap& tasks) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        TaskFileFormat format = formatOf(path);
+        string buffer;
+        buffer.reserve(WRITE_BUFFER + 4096);
+        bool ok = true;
+        auto flush = [&] {
+            ok &= fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            buffer.clear();
+        };
+
+        if (format == TaskFileFormat::Csv) buffer += "description,status,priority,due\n";
+        tasks.forEach([&](TaskId id, string_view description, bool completed) {
+            const TaskSchedule& schedule = tasks.schedule(id);
+            if (format == TaskFileFormat::Csv) {
+                appendCsvField(buffer, description);
+                buffer += completed ? ",completed," : ",pending,";
+                buffer += static_cast<char>('0' + schedule.priority);
+                buffer += ',';
+                if (schedule.hasDueDate()) appendDay(buffer, schedule.dueDay);
+            } else {
+                buffer += "{\"description\":";
+                appendJsonString(buffer, description);
+                buffer += completed ? ",\"completed\":true,\"priority\":" : ",\"completed\":false,\"priority\":";
+                buffer += static_cast<char>('0' + schedule.priority);
+                if (schedule.hasDueDate()) {
+                    buffer += ",\"due\":\"";
+                    appendDay(buffer, schedule.dueDay);
+                    buffer += '"';
+                }
+                buffer += '}';
+            }
+            buffer += '\n';
+            if (buffer.size() >= WRITE_BUFFER) flush();
+        });
+        flush();
+        ok &= fclose(file) == 0;
+        return ok;
+    }
+};
+
+// Class for input validation and user prompts
+class InputManager {
+public:
+    // Prompt user for menu choice between 1 and last
+    int getMenuChoice(int last) {
+        int choice;
+        while (true) {
+            cout << "Enter your choice (1-" << last << "): ";
+            cin >> choice;
+            if (cin.fail() || choice < 1 || choice > last) {
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Please enter a number between 1 and " << last << ".\n";
+            } else {
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                return choice;
+            }
+        }
+    }
+
+    // Prompt user for a task ID (the number shown next to each task)
+    TaskId getTaskId() {
+        uint64_t number;
+        while (true) {
+            cout << "Enter task ID: ";
+            cin >> number;
+            if (cin.fail() || number < 1) {
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Please enter the ID shown next to the task.\n";
+            } else {
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                return TaskId::fromNumber(number);
+            }
+        }
+    }
+
+    // Prompt user for a non-empty task description
+    string getTaskDescription() {
+        string desc;
+        while (true) {
+            cout << "Enter task description: ";
+            getline(cin, desc);
+            if (desc.empty()) {
+                cout << "Task description cannot be empty. Try again!\n";
+            } else {
+                return desc;
+            }
+        }
+    }
+
+    // Prompt user for a priority, 1 to 5, defaulting to 3
+    uint8_t getPriority() {
+        string line;
+        while (true) {
+            cout << "Enter priority 1 (most urgent) to 5, or press Enter for " << int(TaskSchedule::DEFAULT_PRIORITY) << ": ";
+            getline(cin, line);
+            if (line.empty()) return TaskSchedule::DEFAULT_PRIORITY;
+            if (line.size() == 1 && line[0] >= '1' && line[0] <= '5') return static_cast<uint8_t>(line[0] - '0');
+            cout << "Please enter a number between 1 and 5.\n";
+        }
+    }
+
+    // Prompt user for an optional due date
+    int32_t getDueDay() {
+        string line;
+        int32_t day;
+        while (true) {
+            cout << "Enter due date (YYYY-MM-DD), or press Enter for none: ";
+            getline(cin, line);
+            if (line.empty()) return TaskSchedule::NO_DUE_DATE;
+            if (parseDay(line, day)) return day;
+            cout << "That is not a valid date. Try again!\n";
+        }
+    }
+
+    // Prompt user for a file name; empty means cancel
+    string getFilePath(const char* prompt) {
+        string path;
+        cout << prompt << " (.csv or .jsonl), or press Enter to cancel: ";
+        getline(cin, path);
+        return path;
+    }
+
+    // Prompt user for a step of the history to go to; empty means go back
+    string getHistoryCommand() {
+        string command;
+        cout << "u = undo, r = redo, a step number to go to it, or press Enter to go back: ";
+        getline(cin, command);
+        return command;
+    }
+
+    // Prompt user for what to do in the list view; empty means go back
+    string getViewCommand() {
+        string command;
+        cout << "n = next page, p = previous, a page number, a range such as 40-60,\n"
+             << "all / pending / completed to filter, or press Enter to go back: ";
+        getline(cin, command);
+        return command;
+    }
+
+    // Prompt user for the words to search for
+    string getSearchQuery() {
+        string query;
+        while (true) {
+            cout << "Enter words to search for (end a word with * to match its start): ";
+            getline(cin, query);
+            string buffer;
+            vector<string_view> words;
+            TaskSearchIndex::splitWords(query, buffer, words);
+            if (words.empty()) {
+                cout << "Please enter at least one word. Try again!\n";
+            } else {
+                return query;
+            }
+        }
+    }
+
+    // Prompt user for which tasks to include
+    TaskFilter getTaskFilter() {
+        cout << "Show 1. All  2. Pending  3. Completed\n";
+        return static_cast<TaskFilter>(getMenuChoice(3) - 1);
+    }
+};
+
+// Abstract base class for list managers
+class BaseListManager {
+protected:
+    InputManager input;  // For managing user input
+public:
+    virtual ~BaseListManager() = default;
+    virtual void run() = 0;  // Pure virtual function to be implemented by derived class
+};
+
+// Class that manages the to-do list
+class ToDoList : public BaseListManager {
+private:
+    TaskSlotMap tasks;   // All tasks, by ID, in the order they were added
+    TaskStorage storage; // Saves every change to disk
+    TaskSearchIndex index; // Words in descriptions, built on the first search
+    bool indexBuilt = false;
+    TaskScheduler scheduler; // Pending tasks by priority and due date, built when the agenda is first shown
+    bool schedulerBuilt = false;
+    TaskListView view;       // Pages of the list, built when it is first shown
+    bool viewBuilt = false;
+    TaskFilter viewFilter = TaskFilter::All;
+    size_t viewPage = 0;
+    TaskHistory history;     // Every change this session, for undo and redo
+
+    void printTask(TaskId id) const {
+        string line;
+        appendTaskLine(line, tasks, id);
+        cout << line;
+    }
+
+    // Show the current page of the list, written out in one go
+    void showPage() {
+        if (!viewBuilt || view.wantsRebuild()) {
+            view.build(tasks);
+            viewBuilt = true;
+        }
+        static const char* const FILTER_NAMES[] = {"all tasks", "pending tasks", "completed tasks"};
+        size_t pages = max<size_t>(1, (view.count(viewFilter) + TaskListView::PAGE_SIZE - 1) / TaskListView::PAGE_SIZE);
+        viewPage = min(viewPage, pages - 1);
+
+        string screen = "\nYour To-Do List (" + string(FILTER_NAMES[static_cast<int>(viewFilter)]) + "), page " +
+                        to_string(viewPage + 1) + " of " + to_string(pages) + ":\n";
+        view.render(tasks, viewFilter, viewPage * TaskListView::PAGE_SIZE, TaskListView::PAGE_SIZE, screen);
+        if (view.count(viewFilter) == 0) screen += "(none)\n";
+        screen += to_string(view.count(TaskFilter::Pending)) + " pending, " +
+                  to_string(view.count(TaskFilter::Completed)) + " completed\n";
+        cout << screen << flush;
+    }
+
+    // Display the list of tasks a page at a time
+    void viewTasks() {
+        if (tasks.empty()) {
+            cout << "Your to-do list is empty. Add some tasks!\n";
+            return;
+        }
+        while (true) {
+            showPage();
+            string command = input.getViewCommand();
+            if (command.empty()) break;
+            size_t from = 0, to = 0;
+            char extra;
+            if (command == "n") viewPage++;
+            else if (command == "p") viewPage -= viewPage > 0;
+            else if (command == "all") viewFilter = TaskFilter::All, viewPage = 0;
+            else if (command == "pending") viewFilter = TaskFilter::Pending, viewPage = 0;
+            else if (command == "completed") viewFilter = TaskFilter::Completed, viewPage = 0;
+            else if (sscanf(command.c_str(), "%zu-%zu%c", &from, &to, &extra) == 2 && from >= 1 && to >= from) {
+                // Rows from .. to of the current filter, at most MAX_ROWS of them
+                const size_t MAX_ROWS = 1000;
+                string rows;
+                view.render(tasks, viewFilter, from - 1, min(to - from + 1, MAX_ROWS), rows);
+                cout << "\n" << (rows.empty() ? string("(none)\n") : rows);
+                continue;
+            }
+            else if (sscanf(command.c_str(), "%zu%c", &from, &extra) == 1 && from >= 1) viewPage = from - 1;
+            else cout << "Unknown command.\n";
+        }
+    }
+
+    // Asks for the ID of a task that is still on the list
+    TaskId getExistingTaskId() {
+        while (true) {
+            TaskId id = input.getTaskId();
+            if (tasks.contains(id)) return id;
+            cout << "There is no task with that ID. Try again!\n";
+        }
+    }
+
+    // Add a new task to the list
+    void addTask() {
+        string desc = input.getTaskDescription();  // Get task description
+        TaskSchedule schedule;
+        schedule.priority = input.getPriority();
+        schedule.dueDay = input.getDueDay();
+        if (tasks.lastSlot() != TaskSlotMap::NONE) history.touch(tasks, tasks.lastSlot());
+        TaskId id = tasks.add(desc);               // Add to the list
+        tasks.setSchedule(id, schedule);
+        history.touchAdded(id);
+        history.commit(tasks, "Added \"" + desc + "\"");
+        if (indexBuilt) index.add(id.slot, desc);
+        if (schedulerBuilt) scheduler.add(id.slot, schedule);
+        if (viewBuilt) view.added(id.slot, false);
+        bool saved = true;
+        if (storage.isOpen()) {
+            // The log is written in order, so waiting for the last record covers both
+            saved = storage.recordAdd(id, desc, schedule.isDefault()) &&
+                    (schedule.isDefault() || storage.recordSchedule(id, schedule));
+            storage.maybeCompact(tasks);
+        }
+        cout << "Task " << id.number() << " added successfully!\n";
+        if (!saved) cout << "The change could not be saved.\n";
+    }
+
+    // Mark a specific task as completed
+    void markTaskCompleted() {
+        if (tasks.empty()) {
+            cout << "No tasks to mark. Add some tasks first!\n";
+            return;
+        }
+        showPage();  // Show the page the user was looking at
+        TaskId id = getExistingTaskId();
+        if (tasks.isCompleted(id)) {
+            cout << "Task is already marked as completed.\n";
+        } else {
+            history.touch(tasks, id.slot);
+            tasks.markCompleted(id);  // Mark selected task
+            history.commit(tasks, "Completed \"" + string(tasks.description(id)) + "\"");
+            if (schedulerBuilt) scheduler.remove(id.slot);
+            if (viewBuilt) view.completed(id.slot);
+            bool saved = true;
+            if (storage.isOpen()) {
+                saved = storage.recordComplete(id);
+                storage.maybeCompact(tasks);
+            }
+            cout << "Task marked as completed!\n";
+            if (!saved) cout << "The change could not be saved.\n";
+        }
+    }
+
+    // Remove a task from the list
+    void removeTask() {
+        if (tasks.empty()) {
+            cout << "No tasks to remove. Add some tasks first!\n";
+            return;
+        }
+        showPage();  // Show the page the user was looking at
+        TaskId id = getExistingTaskId();
+        string desc(tasks.description(id));              // Store description for confirmation
+        if (indexBuilt) index.remove(id.slot, desc);
+        if (schedulerBuilt) scheduler.remove(id.slot);
+        if (viewBuilt) view.removed(id.slot, tasks.isCompleted(id));
+        history.touch(tasks, id.slot);
+        if (tasks.slotBefore(id.slot) != TaskSlotMap::NONE) history.touch(tasks, tasks.slotBefore(id.slot));
+        tasks.remove(id);                                 // Remove task from the list
+        history.commit(tasks, "Removed \"" + desc + "\"");
+        bool saved = true;
+        if (storage.isOpen()) {
+            saved = storage.recordRemove(id);
+            storage.maybeCompact(tasks);
+        }
+        cout << "Task \"" << desc << "\" removed successfully!\n";
+        if (!saved) cout << "The change could not be saved.\n";
+    }
+
+    // Find tasks by the words in their descriptions
+    void searchTasks() {
+        if (tasks.empty()) {
+            cout << "No tasks to search. Add some tasks first!\n";
+            return;
+        }
+        string query = input.getSearchQuery();
+        TaskFilter filter = input.getTaskFilter();
+        if (!indexBuilt) {
+            index.build(tasks);
+            indexBuilt = true;
+        }
+
+        const size_t SHOWN = 50;
+        size_t found = 0;
+        for (uint32_t slot : index.search(query)) {
+            TaskId id = tasks.idOfSlot(slot);
+            bool completed = tasks.isCompleted(id);
+            if ((filter == TaskFilter::Pending && completed) || (filter == TaskFilter::Completed && !completed))
+                continue;
+            if (found++ < SHOWN) printTask(id);
+        }
+        if (found > SHOWN) cout << "... and " << found - SHOWN << " more\n";
+        cout << (found == 0 ? "No tasks match." : to_string(found) + " task(s) match.") << "\n";
+    }
+
+    // Show overdue tasks, what is due next and the most urgent pending tasks
+    void showAgenda() {
+        if (!schedulerBuilt) {
+            scheduler.build(tasks);
+            schedulerBuilt = true;
+        }
+        if (scheduler.size() == 0) {
+            cout << "Nothing pending. Enjoy your day!\n";
+            return;
+        }
+        const size_t SHOWN = 10;
+        int32_t now = today();
+        auto printSection = [this](const char* title, const vector<uint32_t>& slots) {
+            if (slots.empty()) return;
+            cout << "\n" << title << ":\n";
+            for (uint32_t slot : slots) printTask(tasks.idOfSlot(slot));
+        };
+        printSection("Overdue", scheduler.overdue(now, SHOWN));
+        printSection("Due next", scheduler.dueFrom(now, SHOWN));
+        printSection("Most urgent", scheduler.mostUrgent(SHOWN));
+        cout << endl;
+    }
+
+    // Add every task in a CSV or JSON lines file
+    void importTasks() {
+        string path = input.getFilePath("Enter the file to import");
+        if (path.empty()) return;
+        auto start = chrono::steady_clock::now();
+        TaskFile::ImportResult result = TaskFile::import(path, tasks);
+        if (!result.opened) {
+            cout << "Could not open " << path << ".\n";
+            return;
+        }
+        // Rebuilt from the whole list when next needed
+        indexBuilt = schedulerBuilt = viewBuilt = false;
+        index.clear();
+        // Keeping the import undoable would mean a history entry per task
+        if (result.added > 0) history.clear();
+        // One snapshot holds the lot, rather than a log record per task
+        if (result.added > 0 && storage.isOpen() && !storage.compactNow(tasks))
+            cout << "The imported tasks could not be saved.\n";
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << fixed << setprecision(2) << "Imported " << result.added << " task(s) in " << seconds << " s.\n"
+             << resetiosflags(ios::fixed);
+        if (result.skipped > 0)
+            cout << "Skipped " << result.skipped << " line(s) that could not be read, the first on line "
+                 << result.firstSkippedLine << ".\n";
+    }
+
+    // Move the list to a step of the history, saving and indexing each change
+    void goToStep(size_t step) {
+        using Change = TaskHistory::Change;
+        size_t restored = 0;
+        history.moveTo(tasks, step, [&](Change change, const TaskHistory::TaskState& before,
+                                        const TaskHistory::TaskState& after) {
+            if (change == Change::Removed) {
+                if (indexBuilt) index.remove(before.id.slot, before.description);
+                if (schedulerBuilt) scheduler.remove(before.id.slot);
+                if (viewBuilt) view.removed(before.id.slot, before.completed);
+                if (storage.isOpen()) storage.recordRemove(before.id, false);
+                return;
+            }
+            if (change == Change::Restored) {
+                restored++;
+                if (indexBuilt) index.add(after.id.slot, after.description);
+                if (storage.isOpen())
+                    storage.recordRestore(after.id, after.successor, after.completed, after.schedule, after.description, false);
+            } else {
+                if (viewBuilt) {
+                    if (before.completed == after.completed) view.changed(after.id.slot);
+                    else if (after.completed) view.completed(after.id.slot);
+                    else view.reopened(after.id.slot);
+                }
+                if (storage.isOpen()) {
+                    if (before.completed != after.completed) {
+                        if (after.completed) storage.recordComplete(after.id, false);
+                        else storage.recordReopen(after.id, false);
+                    }
+                    storage.recordSchedule(after.id, after.schedule, false);
+                }
+            }
+            if (schedulerBuilt) {
+                if (after.completed) scheduler.remove(after.id.slot);
+                else scheduler.add(after.id.slot, after.schedule);
+            }
+        });
+        // Restored tasks go back in the middle of the list, where the view
+        // cannot insert them
+        if (restored > 0) viewBuilt = false;
+        if (storage.isOpen()) {
+            if (!storage.sync()) cout << "The change could not be saved.\n";
+            storage.maybeCompact(tasks);
+        }
+    }
+
+    // Show the recent history and undo, redo or go to any step of it
+    void showHistory() {
+        const size_t SHOWN = 10;
+        while (true) {
+            size_t now = history.position();
+            size_t from = now > SHOWN ? now - SHOWN : 0;
+            size_t to = min(history.size(), now + SHOWN + 1);
+            string screen = "\nHistory, at step " + to_string(now) + " of " + to_string(history.size() - 1) + ":\n";
+            for (size_t step = from; step < to; step++)
+                screen += (step == now ? "> " : "  ") + to_string(step) + ". " + history.label(step) +
+                          (step > now ? " (undone)\n" : "\n");
+            cout << screen;
+
+            string command = input.getHistoryCommand();
+            size_t step;
+            char extra;
+            if (command.empty()) {
+                break;
+            } else if (command == "u") {
+                if (now == 0) cout << "Nothing to undo.\n";
+                else goToStep(now - 1);
+            } else if (command == "r") {
+                if (now + 1 >= history.size()) cout << "Nothing to redo.\n";
+                else goToStep(now + 1);
+            } else if (sscanf(command.c_str(), "%zu%c", &step, &extra) == 1 && step < history.size()) {
+                goToStep(step);
+            } else {
+                cout << "Unknown command.\n";
+            }
+        }
+    }
+
+    // Write every task to a CSV or JSON lines file
+    void exportTasks() {
+        string path = input.getFilePath("Enter the file to export to");
+        if (path.empty()) return;
+        if (TaskFile::exportTo(path, tasks)) {
+            cout << "Exported " << tasks.size() << " task(s) to " << path << ".\n";
+        } else {
+            cout << "Could not write " << path << ".\n";
+        }
+    }
+
+public:
+    // Loads the list saved under prefix; an empty prefix keeps it in memory only
+    explicit ToDoList(const string& prefix = DATA_PREFIX) {
+        if (prefix.empty()) return;
+        if (!storage.open(prefix, tasks)) {
+            tasks = TaskSlotMap();
+            cout << "Could not open the saved list (" << prefix << ".*"
+                 << (storage.isBusy() ? ", another process has it open" : "") << "); changes will not be saved.\n";
+        } else if (!tasks.empty()) {
+            cout << "Loaded " << tasks.size() << " saved task(s).\n";
+        }
+    }
+
+    // Run the main loop of the to-do list manager
+    void run() override {
+        int choice;
+        do {
+            cout << "\nTo-Do List Manager\n";
+            cout << "1. Add Task\n";
+            cout << "2. View Tasks\n";
+            cout << "3. Mark Task as Completed\n";
+            cout << "4. Remove Task\n";
+            cout << "5. Search Tasks\n";
+            cout << "6. Show Agenda\n";
+            cout << "7. Import Tasks\n";
+            cout << "8. Export Tasks\n";
+            cout << "9. Undo / Redo\n";
+            cout << "10. Exit\n";
+            choice = input.getMenuChoice(10);  // Get user's choice
+
+            switch (choice) {
+                case 1:
+                    addTask();
+                    break;
+                case 2:
+                    viewTasks();
+                    break;
+                case 3:
+                    markTaskCompleted();
+                    break;
+                case 4:
+                    removeTask();
+                    break;
+                case 5:
+                    searchTasks();
+                    break;
+                case 6:
+                    showAgenda();
+                    break;
+                case 7:
+                    importTasks();
+                    break;
+                case 8:
+                    exportTasks();
+                    break;
+                case 9:
+                    showHistory();
+                    break;
+                case 10:
+                    cout << "Goodbye! Stay organized!\n";
+                    break;
+            }
+        } while (choice != 10);  // Exit loop on choice 10
+    }
+};
+
+// Builds the agenda indexes over generated tasks, then times agenda
+// queries with them against scanning every task, and times keeping them
+// up to date as tasks are completed and removed
+void benchmarkAgenda(size_t taskCount) {
+    const size_t SHOWN = 10;
+    mt19937_64 random(11);
+    int32_t now = today();
+    TaskSlotMap tasks;
+    vector<TaskId> ids;
+    for (size_t i = 0; i < taskCount; i++) {
+        TaskId id = tasks.add("Task " + to_string(i), random() % 3 == 0);
+        TaskSchedule schedule;
+        schedule.priority = static_cast<uint8_t>(1 + random() % 5);
+        if (random() % 2) schedule.dueDay = now - 365 + static_cast<int32_t>(random() % 730);
+        tasks.setSchedule(id, schedule);
+        ids.push_back(id);
+    }
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    auto start = chrono::steady_clock::now();
+    TaskScheduler scheduler;
+    scheduler.build(tasks);
+    cout << fixed << setprecision(1) << "Scheduled " << scheduler.size() << " pending of " << taskCount
+         << " tasks in " << seconds(start) * 1e3 << " ms\n";
+
+    // The same three queries by looking at every task
+    auto scanFor = [&](int query) {
+        vector<pair<pair<int64_t, int64_t>, uint32_t>> found;
+        tasks.forEach([&](TaskId id, string_view, bool completed) {
+            const TaskSchedule& schedule = tasks.schedule(id);
+            if (completed) return;
+            if (query == 2) found.push_back({{schedule.priority, schedule.dueDay}, id.slot});
+            else if (schedule.hasDueDate() && (query == 0 ? schedule.dueDay < now : schedule.dueDay >= now))
+                found.push_back({{schedule.dueDay, 0}, id.slot});
+        });
+        size_t shown = min(SHOWN, found.size());
+        partial_sort(found.begin(), found.begin() + shown, found.end());
+        vector<uint32_t> slots;
+        for (size_t i = 0; i < shown; i++) slots.push_back(found[i].second);
+        return slots;
+    };
+    const char* names[] = {"overdue", "due next", "most urgent"};
+    for (int query = 0; query < 3; query++) {
+        start = chrono::steady_clock::now();
+        vector<uint32_t> indexed = query == 0 ? scheduler.overdue(now, SHOWN)
+                                 : query == 1 ? scheduler.dueFrom(now, SHOWN) : scheduler.mostUrgent(SHOWN);
+        double indexSeconds = seconds(start);
+        start = chrono::steady_clock::now();
+        vector<uint32_t> scanned = scanFor(query);
+        double scanSeconds = seconds(start);
+        cout << setprecision(3) << "  " << names[query] << ": " << indexSeconds * 1e3 << " ms, scanning "
+             << scanSeconds * 1e3 << " ms" << (indexed == scanned ? "" : " RESULTS DIFFER!") << "\n";
+    }
+
+    const size_t changes = min<size_t>(200000, taskCount);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < changes; i++) {
+        TaskId id = ids[random() % ids.size()];
+        if (!tasks.contains(id)) continue;
+        scheduler.remove(id.slot);
+        if (i % 2) tasks.markCompleted(id);
+        else tasks.remove(id);
+    }
+    cout << setprecision(2) << "  " << changes << " completions and removals: " << seconds(start) * 1e6 / changes
+         << " us each" << (scanFor(2) == scheduler.mostUrgent(SHOWN) ? "" : " INDEX OUT OF DATE!") << "\n"
+         << resetiosflags(ios::fixed);
+}
+
+// Times what showing the list costs before each mark or remove: the whole
+// list formatted line by line, against one page from the list view, cold
+// and cached, and a page shown again after marking a task on it
+void benchmarkView(size_t taskCount) {
+    mt19937_64 random(13);
+    TaskSlotMap tasks;
+    for (size_t i = 0; i < taskCount; i++) tasks.add("Task " + to_string(i), random() % 3 == 0);
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    auto start = chrono::steady_clock::now();
+    ostringstream full;
+    tasks.forEach([&](TaskId id, string_view description, bool completed) {
+        full << id.number() << ". " << description << " [" << (completed ? "Completed" : "Pending") << "]\n";
+    });
+    cout << fixed << setprecision(1) << "Whole list of " << taskCount << " tasks: " << seconds(start) * 1e3
+         << " ms, " << full.str().size() / 1024 << " KB of output\n";
+
+    start = chrono::steady_clock::now();
+    TaskListView view;
+    view.build(tasks);
+    cout << "  building the view: " << seconds(start) * 1e3 << " ms\n";
+
+    const TaskFilter filters[] = {TaskFilter::All, TaskFilter::Pending, TaskFilter::Completed};
+    const char* names[] = {"all", "pending", "completed"};
+    const size_t pages = 100;  // Few enough that their rows all fit in the cache
+    for (int f = 0; f < 3; f++) {
+        size_t lastPage = max<size_t>(1, view.count(filters[f]) / TaskListView::PAGE_SIZE);
+        vector<size_t> chosen;
+        for (size_t i = 0; i < pages; i++) chosen.push_back(random() % lastPage);
+        string screen;
+        double times[2];
+        for (double& time : times) {  // Cold, then again from the cache
+            start = chrono::steady_clock::now();
+            for (size_t page : chosen) {
+                screen.clear();
+                view.render(tasks, filters[f], page * TaskListView::PAGE_SIZE, TaskListView::PAGE_SIZE, screen);
+            }
+            time = seconds(start) / pages;
+        }
+        cout << setprecision(2) << "  a page of " << names[f] << ": " << times[0] * 1e6 << " us, cached "
+             << times[1] * 1e6 << " us\n";
+    }
+
+    // Mark a task on the page being looked at, then show that page again
+    const size_t changes = min<size_t>(100000, view.count(TaskFilter::Pending));
+    string screen;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < changes; i++) {
+        screen.clear();
+        view.render(tasks, TaskFilter::Pending, 0, 1, screen);
+        TaskId id = TaskId::fromNumber(strtoull(screen.c_str(), nullptr, 10));
+        tasks.markCompleted(id);
+        view.completed(id.slot);
+        screen.clear();
+        view.render(tasks, TaskFilter::Pending, 0, TaskListView::PAGE_SIZE, screen);
+    }
+    cout << "  " << changes << " marks, each followed by its page: " << seconds(start) * 1e6 / changes
+         << " us each" << (view.count(TaskFilter::Pending) == tasks.pendingCount() ? "" : " VIEW OUT OF DATE!")
+         << "\n" << resetiosflags(ios::fixed);
+}
+
+// Exports generated tasks as CSV and JSON lines, then times importing
+// them back, in parallel and on one thread, against reading the CSV a line
+// at a time into Task objects
+void benchmarkImport(size_t taskCount) {
+    const string directory = makeScratchDirectory();
+    if (directory.empty()) {
+        cout << "Could not make a directory for the benchmark files: " << strerror(errno) << "\n";
+        return;
+    }
+    const string prefix = directory + "/todo_bench";
+    const char* words[] = {"buy", "milk", "call", "mum", "report", "\"draft\"", "fix", "bike, again", "plan", "trip"};
+    mt19937_64 random(17);
+    int32_t now = today();
+    TaskSlotMap tasks;
+    tasks.reserve(taskCount);
+    for (size_t i = 0; i < taskCount; i++) {
+        string description = "Task " + to_string(i);
+        for (int w = 0; w < 3; w++) description += string(" ") + words[random() % 10];
+        TaskId id = tasks.add(description, random() % 3 == 0);
+        TaskSchedule schedule;
+        schedule.priority = static_cast<uint8_t>(1 + random() % 5);
+        if (random() % 2) schedule.dueDay = now + static_cast<int32_t>(random() % 365);
+        tasks.setSchedule(id, schedule);
+    }
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto same = [](const TaskSlotMap& a, const TaskSlotMap& b) {
+        if (a.size() != b.size()) return false;
+        vector<TaskId> ids;
+        ids.reserve(b.size());
+        b.forEach([&](TaskId id, string_view, bool) { ids.push_back(id); });
+        size_t i = 0;
+        bool equal = true;
+        a.forEach([&](TaskId id, string_view description, bool completed) {
+            TaskId other = ids[i++];
+            equal &= description == b.description(other) && completed == b.isCompleted(other) &&
+                     a.schedule(id).priority == b.schedule(other).priority &&
+                     a.schedule(id).dueDay == b.schedule(other).dueDay;
+        });
+        return equal;
+    };
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << fixed << setprecision(2);
+
+    for (const char* extension : {".csv", ".jsonl"}) {
+        string path = prefix + extension;
+        auto start = chrono::steady_clock::now();
+        bool written = TaskFile::exportTo(path, tasks);
+        double exportSeconds = seconds(start);
+        MappedFile file;
+        file.open(path);
+        cout << extension + 1 << ", " << taskCount << " tasks, " << file.size() / (1 << 20) << " MB: export "
+             << exportSeconds << " s" << (written ? "" : " FAILED") << "\n";
+        file.close();
+
+        for (unsigned threads : {cores, 1u}) {
+            TaskSlotMap imported;
+            start = chrono::steady_clock::now();
+            TaskFile::ImportResult result = TaskFile::import(path, imported, threads);
+            double importSeconds = seconds(start);
+            cout << "  import on " << threads << " thread(s): " << importSeconds << " s, "
+                 << result.added / importSeconds / 1e6 << "M tasks/s"
+                 << (result.skipped == 0 && same(tasks, imported) ? "" : " TASKS DIFFER!") << "\n";
+            if (cores == 1) break;
+        }
+    }
+
+    // What loading used to look like: a line at a time, a Task at a time
+    auto start = chrono::steady_clock::now();
+    vector<Task> loaded;
+    FILE* file = fopen((prefix + ".csv").c_str(), "rb");
+    char line[4096];
+    while (file && fgets(line, sizeof(line), file)) {
+        string text(line);
+        size_t comma = text.rfind(',', text.rfind(',', text.rfind(',') - 1) - 1);
+        loaded.push_back(Task(text.substr(0, comma), text.compare(comma + 1, 9, "completed") == 0));
+    }
+    if (file) fclose(file);
+    cout << "  csv a line at a time into Task objects: " << seconds(start) << " s\n" << resetiosflags(ios::fixed);
+    remove((prefix + ".csv").c_str());
+    remove((prefix + ".jsonl").c_str());
+    removeScratchDirectory(directory);
+}
+
+#ifdef __linux__
+// One immutable version of the list, as served to readers. Slots are
+// grouped into chunks of CHUNK_SIZE, found through a trie over chunk
+// numbers (FANOUT children per node, as in TaskHistory). A new version
+// copies only the chunks a write batch touched and the trie nodes on the
+// paths to them, O(log n) per chunk; the rest are shared with older versions.
+struct TaskChunk {
+    static const size_t CHUNK_SIZE = 256;
+
+    struct Entry {
+        uint32_t generation = 0;
+        bool occupied = false;
+        bool completed = false;
+        string description;
+    };
+    Entry entries[CHUNK_SIZE];
+};
+
+class TaskVersion {
+    static const unsigned BITS = 4;
+    static const size_t FANOUT = 1 << BITS;
+
+    // Children are Nodes, or TaskChunks on the bottom level
+    struct Node {
+        shared_ptr<const void> children[FANOUT];
+    };
+
+    shared_ptr<const void> root;
+    unsigned levels = 1;
+
+    // node with chunk number index set to chunk, copying the path down to it
+    static shared_ptr<const void> with(const shared_ptr<const void>& node, unsigned level, size_t index,
+                                       shared_ptr<const TaskChunk> chunk) {
+        auto copy = node ? make_shared<Node>(*static_cast<const Node*>(node.get())) : make_shared<Node>();
+        size_t child = index >> (level * BITS) & (FANOUT - 1);
+        if (level == 0) copy->children[child] = move(chunk);
+        else copy->children[child] = with(copy->children[child], level - 1, index, move(chunk));
+        return copy;
+    }
+
+    template <typename Visit>
+    static bool visitChunks(const void* node, unsigned level, size_t base, Visit& visit) {
+        if (!node) return true;
+        for (size_t i = 0; i < FANOUT; i++) {
+            const void* child = static_cast<const Node*>(node)->children[i].get();
+            size_t index = base | i << (level * BITS);
+            if (level == 0 ? child && !visit(index, *static_cast<const TaskChunk*>(child))
+                           : !visitChunks(child, level - 1, index, visit))
+                return false;
+        }
+        return true;
+    }
+
+public:
+    uint64_t number = 0;
+    size_t pending = 0;
+    size_t completed = 0;
+
+    const TaskChunk* chunk(size_t index) const {
+        if (index >> (levels * BITS) != 0) return nullptr;
+        const void* node = root.get();
+        for (unsigned level = levels; node && level-- > 0;)
+            node = static_cast<const Node*>(node)->children[index >> (level * BITS) & (FANOUT - 1)].get();
+        return static_cast<const TaskChunk*>(node);
+    }
+
+    // Replaces a chunk in this (not yet published) version
+    void setChunk(size_t index, shared_ptr<const TaskChunk> chunk) {
+        while (index >> (levels * BITS) != 0) {
+            auto parent = make_shared<Node>();
+            parent->children[0] = move(root);
+            root = move(parent);
+            levels++;
+        }
+        root = with(root, levels - 1, index, move(chunk));
+    }
+
+    // Calls visit(index, chunk) for every chunk in slot order until it returns false
+    template <typename Visit>
+    void forEachChunk(Visit visit) const { visitChunks(root.get(), levels - 1, 0, visit); }
+
+    const TaskChunk::Entry* find(TaskId id) const {
+        const TaskChunk* found = chunk(id.slot / TaskChunk::CHUNK_SIZE);
+        if (!found) return nullptr;
+        const TaskChunk::Entry& entry = found->entries[id.slot % TaskChunk::CHUNK_SIZE];
+        return entry.occupied && entry.generation == id.generation ? &entry : nullptr;
+    }
+};
+
+// Hands the current TaskVersion to reader threads without locks (RCU
+// style). A reader announces the epoch it started in before loading the
+// pointer; a replaced version is deleted once every reader is idle or has
+// announced a later epoch, so none can still be looking at it. Only the
+// writer thread calls publish().
+class VersionPublisher {
+public:
+    static const int MAX_READERS = 256;
+
+private:
+    struct alignas(64) ReaderSlot {
+        atomic<uint64_t> epoch{0};    // 0 while not reading
+        atomic<bool> used{false};
+    };
+
+    ReaderSlot readers[MAX_READERS];
+    atomic<const TaskVersion*> current{nullptr};
+    atomic<uint64_t> epoch{1};
+    vector<pair<const TaskVersion*, uint64_t>> retired;  // With the epoch they were replaced in
+
+    void reclaim() {
+        uint64_t oldest = UINT64_MAX;
+        for (ReaderSlot& reader : readers) {
+            uint64_t announced = reader.epoch.load();
+            if (announced != 0) oldest = min(oldest, announced);
+        }
+        size_t kept = 0;
+        for (auto& version : retired) {
+            if (version.second < oldest) delete version.first;
+            else retired[kept++] = version;
+        }
+        retired.resize(kept);
+    }
+
+public:
+    VersionPublisher() = default;
+    VersionPublisher(const VersionPublisher&) = delete;
+    VersionPublisher& operator=(const VersionPublisher&) = delete;
+
+    ~VersionPublisher() {
+        for (auto& version : retired) delete version.first;
+        delete current.load();
+    }
+
+    // Returns a reader number, or -1 if MAX_READERS are already taken
+    int registerReader() {
+        for (int i = 0; i < MAX_READERS; i++) {
+            bool expected = false;
+            if (readers[i].used.compare_exchange_strong(expected, true)) return i;
+        }
+        return -1;
+    }
+    void unregisterReader(int reader) { readers[reader].used.store(false); }
+
+    // The version stays valid until the same reader calls exit()
+    const TaskVersion* enter(int reader) {
+        readers[reader].epoch.store(epoch.load());
+        return current.load();
+    }
+    void exit(int reader) { readers[reader].epoch.store(0); }
+
+    // The version the writer last published
+    const TaskVersion* latest() const { return current.load(); }
+
+    void publish(const TaskVersion* version) {
+        const TaskVersion* old = current.exchange(version);
+        if (old) retired.emplace_back(old, epoch.fetch_add(1));
+        reclaim();
+    }
+};
+
+// Buffered line-at-a-time reading and writing on a socket. Replies are
+// sent just before the next blocking read, so pipelined requests are
+// answered in one write.
+class LineConnection {
+private:
+    int fd;
+    string input;
+    size_t start = 0;
+    string output;
+
+public:
+    explicit LineConnection(int socket) : fd(socket) {}
+
+    bool readLine(string& line) {
+        while (true) {
+            size_t end = input.find('\n', start);
+            if (end != string::npos) {
+                line.assign(input, start, end - start);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                start = end + 1;
+                return true;
+            }
+            input.erase(0, start);
+            start = 0;
+            if (!flush()) return false;
+            char buffer[1 << 16];
+            ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+            if (got <= 0) return false;
+            input.append(buffer, static_cast<size_t>(got));
+        }
+    }
+
+    void write(string_view text) { output.append(text); }
+
+    bool flush() {
+        for (size_t sent = 0; sent < output.size();) {
+            ssize_t done = send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+            if (done <= 0) return false;
+            sent += static_cast<size_t>(done);
+        }
+        output.clear();
+        return true;
+    }
+};
+
+// Fills in a Unix-domain socket address, refusing paths that do not fit
+bool makeSocketAddress(const string& path, sockaddr_un& address) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cout << "Socket path is too long: " << path << "\n";
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+// Set from SIGINT/SIGTERM so the server can close the list cleanly
+atomic<bool> serverStopping{false};
+
+void stopServer(int) { serverStopping.store(true); }
+
+// Serves the list over a Unix socket, one line per request:
+//   GET <id>                      OK <id> <0|1 completed> <description>
+//   COUNT                         OK <pending> <completed> <version>
+//   LIST [all|pending|completed] [limit]   OK <n>, then n lines as for GET
+//   ADD <description>             OK <id>
+//   DONE <id> / DEL <id>          OK
+// and ERR <reason> on failure. Reads are answered from the latest
+// published TaskVersion without taking any lock. Writes are queued for a
+// single writer thread, which applies everything waiting, logs it with one
+// sync, publishes one new version and then answers the whole batch.
+class TaskServer {
+private:
+    struct WriteRequest {
+        enum Kind { Add, Complete, Remove } kind;
+        TaskId id{0, 0};
+        string description;
+        bool ok = false;
+        bool saved = true;     // False if the log could not be written
+        bool done = false;
+    };
+
+    string socketPath;
+    TaskSlotMap tasks;           // Only the writer thread touches these
+    TaskStorage storage;
+    VersionPublisher publisher;
+
+    mutex queueLock;
+    condition_variable queued;
+    condition_variable committed;
+    vector<WriteRequest*> queue;
+    bool writerStopping = false;
+
+    mutex clientsLock;
+    condition_variable clientsDone;
+    vector<int> clients;
+
+    void refresh(TaskChunk::Entry& entry, uint32_t slot) const {
+        TaskId id = tasks.idOfSlot(slot);
+        entry.generation = id.generation;
+        entry.occupied = tasks.contains(id);
+        entry.completed = entry.occupied && tasks.isCompleted(id);
+        if (entry.occupied) entry.description.assign(tasks.description(id));
+        else entry.description.clear();
+    }
+
+    // Publishes a version in which only the chunks holding touched slots,
+    // and the trie nodes above them, are new copies
+    void publishVersion(vector<uint32_t>& touched) {
+        const TaskVersion* previous = publisher.latest();
+        TaskVersion* version = previous ? new TaskVersion(*previous) : new TaskVersion();
+        version->number = previous ? previous->number + 1 : 1;
+
+        sort(touched.begin(), touched.end());
+        for (size_t i = 0; i < touched.size();) {
+            size_t chunk = touched[i] / TaskChunk::CHUNK_SIZE;
+            const TaskChunk* old = version->chunk(chunk);
+            shared_ptr<TaskChunk> copy = old ? make_shared<TaskChunk>(*old) : make_shared<TaskChunk>();
+            for (; i < touched.size() && touched[i] / TaskChunk::CHUNK_SIZE == chunk; i++)
+                refresh(copy->entries[touched[i] % TaskChunk::CHUNK_SIZE], touched[i]);
+            version->setChunk(chunk, move(copy));
+        }
+        version->completed = tasks.completedCount();
+        version->pending = tasks.size() - version->completed;
+        publisher.publish(version);
+    }
+
+    void writerLoop() {
+        vector<WriteRequest*> batch;
+        vector<uint32_t> touched;
+        while (true) {
+            {
+                unique_lock<mutex> guard(queueLock);
+                queued.wait(guard, [this] { return writerStopping || !queue.empty(); });
+                if (queue.empty()) return;
+                batch.swap(queue);
+            }
+            touched.clear();
+            for (WriteRequest* request : batch) {
+                if (request->kind == WriteRequest::Add) {
+                    request->id = tasks.add(request->description);
+                    request->ok = true;
+                    if (storage.isOpen()) storage.recordAdd(request->id, request->description, false);
+                } else if (request->kind == WriteRequest::Complete) {
+                    request->ok = tasks.markCompleted(request->id);
+                    if (request->ok && storage.isOpen()) storage.recordComplete(request->id, false);
+                } else {
+                    request->ok = tasks.remove(request->id);
+                    if (request->ok && storage.isOpen()) storage.recordRemove(request->id, false);
+                }
+                if (request->ok) touched.push_back(request->id.slot);
+            }
+            if (storage.isOpen()) {
+                bool saved = storage.sync();
+                for (WriteRequest* request : batch) request->saved = saved;
+                storage.maybeCompact(tasks);
+            }
+            if (!touched.empty()) publishVersion(touched);
+
+            lock_guard<mutex> guard(queueLock);
+            for (WriteRequest* request : batch) request->done = true;
+            batch.clear();
+            committed.notify_all();
+        }
+    }
+
+    // Waits until the writer has applied and logged the request
+    void submit(WriteRequest& request) {
+        unique_lock<mutex> guard(queueLock);
+        queue.push_back(&request);
+        queued.notify_one();
+        committed.wait(guard, [&request] { return request.done; });
+    }
+
+    static bool parseId(const string& text, TaskId& id) {
+        char* end = nullptr;
+        uint64_t number = strtoull(text.c_str(), &end, 10);
+        if (text.empty() || *end != '\0' || number == 0) return false;
+        id = TaskId::fromNumber(number);
+        return true;
+    }
+
+    static void writeTask(LineConnection& connection, TaskId id, const TaskChunk::Entry& entry) {
+        connection.write(to_string(id.number()) + (entry.completed ? " 1 " : " 0 "));
+        connection.write(entry.description);
+        connection.write("\n");
+    }
+
+    void handle(LineConnection& connection, int reader, const string& line) {
+        size_t space = line.find(' ');
+        string command = line.substr(0, space);
+        string argument = space == string::npos ? "" : line.substr(space + 1);
+        TaskId id;
+
+        if (command == "GET" || command == "COUNT" || command == "LIST") {
+            const TaskVersion* version = publisher.enter(reader);
+            if (command == "COUNT") {
+                connection.write("OK " + to_string(version->pending) + " " + to_string(version->completed) + " " +
+                                 to_string(version->number) + "\n");
+            } else if (command == "GET") {
+                const TaskChunk::Entry* entry = parseId(argument, id) ? version->find(id) : nullptr;
+                if (entry) {
+                    connection.write("OK ");
+                    writeTask(connection, id, *entry);
+                } else {
+                    connection.write("ERR no such task\n");
+                }
+            } else {
+                string which = argument.substr(0, argument.find(' '));
+                size_t limit = argument.find(' ') == string::npos ? 20 : strtoull(argument.c_str() + argument.find(' '), nullptr, 10);
+                TaskFilter filter = which == "pending" ? TaskFilter::Pending
+                                  : which == "completed" ? TaskFilter::Completed : TaskFilter::All;
+                vector<pair<TaskId, const TaskChunk::Entry*>> shown;
+                version->forEachChunk([&](size_t chunk, const TaskChunk& entries) {
+                    for (size_t i = 0; i < TaskChunk::CHUNK_SIZE && shown.size() < limit; i++) {
+                        const TaskChunk::Entry& entry = entries.entries[i];
+                        if (!entry.occupied || (filter == TaskFilter::Pending && entry.completed) ||
+                            (filter == TaskFilter::Completed && !entry.completed))
+                            continue;
+                        shown.emplace_back(TaskId{static_cast<uint32_t>(chunk * TaskChunk::CHUNK_SIZE + i),
+                                                  entry.generation}, &entry);
+                    }
+                    return shown.size() < limit;
+                });
+                connection.write("OK " + to_string(shown.size()) + "\n");
+                for (auto& task : shown) writeTask(connection, task.first, *task.second);
+            }
+            publisher.exit(reader);
+            return;
+        }
+
+        WriteRequest request;
+        if (command == "ADD" && !argument.empty()) {
+            request.kind = WriteRequest::Add;
+            request.description = argument;
+        } else if ((command == "DONE" || command == "DEL") && parseId(argument, request.id)) {
+            request.kind = command == "DONE" ? WriteRequest::Complete : WriteRequest::Remove;
+        } else {
+            connection.write("ERR unknown command\n");
+            return;
+        }
+        submit(request);
+        if (!request.ok) connection.write("ERR no such task\n");
+        else if (!request.saved) connection.write("ERR could not save\n");
+        else if (request.kind == WriteRequest::Add) connection.write("OK " + to_string(request.id.number()) + "\n");
+        else connection.write("OK\n");
+    }
+
+    void serveClient(int fd) {
+        int reader = publisher.registerReader();
+        LineConnection connection(fd);
+        if (reader < 0) {
+            connection.write("ERR server busy\n");
+            connection.flush();
+        } else {
+            string line;
+            while (connection.readLine(line)) handle(connection, reader, line);
+            publisher.unregisterReader(reader);
+        }
+        close(fd);
+        lock_guard<mutex> guard(clientsLock);
+        clients.erase(find(clients.begin(), clients.end(), fd));
+        clientsDone.notify_all();
+    }
+
+public:
+    explicit TaskServer(const string& path) : socketPath(path) {}
+
+    // True if open() failed because another process has the list open
+    bool isBusy() const { return storage.isBusy(); }
+
+    // Serves the list saved under prefix; an empty prefix serves one kept in memory only
+    bool open(const string& prefix) {
+        if (!prefix.empty() && !storage.open(prefix, tasks)) return false;
+        vector<uint32_t> all(tasks.slotCount());
+        for (uint32_t slot = 0; slot < all.size(); slot++) all[slot] = slot;
+        publishVersion(all);
+        return true;
+    }
+
+    // Binds the socket and serves clients until SIGINT or SIGTERM
+    bool run() {
+        sockaddr_un address;
+        if (!makeSocketAddress(socketPath, address))
+            return false;
+        signal(SIGPIPE, SIG_IGN);
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+
+        unlink(socketPath.c_str()); // Leftover from a previous run
+        int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listenFd, SOMAXCONN) < 0) {
+            cout << "Could not listen on " << socketPath << ": " << strerror(errno) << "\n";
+            if (listenFd >= 0) close(listenFd);
+            return false;
+        }
+        cout << "Serving " << tasks.size() << " task(s) on " << socketPath << " (Ctrl+C to stop)\n";
+        thread writer(&TaskServer::writerLoop, this);
+
+        while (!serverStopping.load()) {
+            pollfd waiting{listenFd, POLLIN, 0};
+            if (poll(&waiting, 1, 200) <= 0) continue; // Wake up now and then to notice a signal
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) continue;
+            lock_guard<mutex> guard(clientsLock);
+            clients.push_back(fd);
+            thread(&TaskServer::serveClient, this, fd).detach();
+        }
+
+        close(listenFd);
+        unlink(socketPath.c_str());
+        {
+            // Wake clients blocked in recv() so their threads can finish
+            unique_lock<mutex> guard(clientsLock);
+            for (int fd : clients) shutdown(fd, SHUT_RDWR);
+            clientsDone.wait(guard, [this] { return clients.empty(); });
+        }
+        {
+            lock_guard<mutex> guard(queueLock);
+            writerStopping = true;
+            queued.notify_one();
+        }
+        writer.join();
+        storage.close();
+        cout << "Server stopped.\n";
+        return true;
+    }
+};
+
+// Drives a TaskServer from several connections and reports throughput and
+// how long requests took to be answered. Most requests are GET or COUNT;
+// writePercent of them are ADD or DONE. Each client has one request in
+// flight at a time, so latency is the full round trip.
+class LoadGenerator {
+private:
+    static const size_t PREFILL = 10000; // Tasks added first, for GET and DONE to use
+
+    string socketPath;
+    int clients;
+    double seconds;
+    int writePercent;
+    vector<string> ids;
+
+    int connectClient() const {
+        sockaddr_un address;
+        makeSocketAddress(socketPath, address);
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void runClient(int client, vector<float>& readLatencies, vector<float>& writeLatencies, long long& failures) {
+        int fd = connectClient();
+        if (fd < 0) {
+            failures++;
+            return;
+        }
+        LineConnection connection(fd);
+        mt19937_64 random(client + 1);
+        string reply;
+        auto stopAt = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+        while (chrono::steady_clock::now() < stopAt) {
+            bool write = static_cast<int>(random() % 100) < writePercent;
+            const string& id = ids[random() % ids.size()];
+            if (write) connection.write(random() % 2 ? "ADD Load test task\n" : "DONE " + id + "\n");
+            else connection.write(random() % 5 ? "GET " + id + "\n" : string("COUNT\n"));
+            auto sentAt = chrono::steady_clock::now();
+            if (!connection.readLine(reply)) {
+                failures++;
+                break;
+            }
+            (write ? writeLatencies : readLatencies)
+                .push_back(chrono::duration<float, micro>(chrono::steady_clock::now() - sentAt).count());
+            if (reply.compare(0, 2, "OK") != 0) failures++;
+        }
+        close(fd);
+    }
+
+    // Throughput is over elapsed, the time the clients actually ran
+    void report(const char* kind, vector<vector<float>>& perClient, double elapsed) const {
+        vector<float> all;
+        for (vector<float>& latencies : perClient) all.insert(all.end(), latencies.begin(), latencies.end());
+        if (all.empty()) return;
+        auto percentile = [&](double p) {
+            size_t index = min(all.size() - 1, static_cast<size_t>(p * all.size()));
+            nth_element(all.begin(), all.begin() + index, all.end());
+            return all[index];
+        };
+        cout << "  " << kind << ": " << all.size() / elapsed << " requests/sec, latency p50 " << percentile(0.50)
+             << "us, p99 " << percentile(0.99) << "us, p99.9 " << percentile(0.999) << "us\n";
+    }
+
+public:
+    LoadGenerator(const string& path, int clients, double seconds, int writePercent)
+        : socketPath(path), clients(max(1, clients)), seconds(seconds), writePercent(writePercent) {}
+
+    void run() {
+        signal(SIGPIPE, SIG_IGN);
+        int fd = connectClient();
+        if (fd < 0) {
+            cout << "Could not connect to " << socketPath << ": " << strerror(errno) << "\n";
+            return;
+        }
+        {
+            // Pipelined, so the server commits these in a few large batches
+            LineConnection connection(fd);
+            string reply;
+            for (size_t i = 0; i < PREFILL; i++) connection.write("ADD Load test task " + to_string(i) + "\n");
+            for (size_t i = 0; i < PREFILL && connection.readLine(reply); i++)
+                if (reply.compare(0, 3, "OK ") == 0) ids.push_back(reply.substr(3));
+            close(fd);
+        }
+        if (ids.empty()) {
+            cout << "The server did not accept any tasks.\n";
+            return;
+        }
+
+        vector<vector<float>> readLatencies(clients), writeLatencies(clients);
+        vector<long long> failures(clients, 0);
+        vector<thread> workers;
+        auto start = chrono::steady_clock::now();
+        for (int c = 0; c < clients; c++)
+            workers.emplace_back(&LoadGenerator::runClient, this, c, ref(readLatencies[c]), ref(writeLatencies[c]),
+                                 ref(failures[c]));
+        for (thread& worker : workers)
+            worker.join();
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        long long failed = 0;
+        for (long long count : failures) failed += count;
+        cout << fixed << setprecision(1) << clients << " clients, " << writePercent << "% writes, "
+             << setprecision(2) << elapsed << "s\n" << setprecision(1);
+        report("reads ", readLatencies, elapsed);
+        report("writes", writeLatencies, elapsed);
+        if (failed > 0) cout << "  " << failed << " requests failed\n";
+        cout << resetiosflags(ios::fixed) << setprecision(6);
+    }
+};
+#endif
+
+// Times the log and snapshot: durable adds from several threads (group
+// commit), bulk adds synced once, and opening a saved list of that size
+void benchmarkStorage(size_t taskCount, int threads) {
+    const string directory = makeScratchDirectory();
+    if (directory.empty()) {
+        cout << "Could not make a directory for the benchmark files: " << strerror(errno) << "\n";
+        return;
+    }
+    const string prefix = directory + "/todo_bench";
+    auto openOrStop = [&](TaskStorage& storage, TaskSlotMap& list) {
+        if (storage.open(prefix, list)) return true;
+        cout << "Could not open the benchmark files in " << directory << ".\n";
+        storage.close();
+        TaskStorage::destroy(prefix);
+        removeScratchDirectory(directory);
+        return false;
+    };
+    TaskSlotMap tasks;
+
+    // Every add waits until it is on disk, as in the interactive manager
+    for (int writers : {1, threads}) {
+        TaskStorage storage;
+        if (!openOrStop(storage, tasks)) return;
+        const size_t perWriter = 2000;
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int i = 0; i < writers; i++)
+            workers.emplace_back([&storage, i] {
+                for (size_t n = 0; n < perWriter; n++)
+                    storage.recordAdd(TaskId{static_cast<uint32_t>(i * perWriter + n), 0}, "Durable task");
+            });
+        for (thread& worker : workers) worker.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        uint64_t syncs = storage.getSyncCount();
+        cout << fixed << setprecision(1) << writers << " writer(s), each add waiting for disk: "
+             << writers * perWriter / seconds << " adds/s, " << double(writers * perWriter) / max<uint64_t>(1, syncs)
+             << " adds per fsync\n";
+        storage.close();
+        TaskStorage::destroy(prefix);
+    }
+
+    // Bulk load: append everything, then one sync
+    {
+        TaskStorage storage;
+        tasks = TaskSlotMap();
+        if (!openOrStop(storage, tasks)) return;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < taskCount; i++)
+            storage.recordAdd(TaskId{static_cast<uint32_t>(i), 0}, "Bulk task number " + to_string(i), false);
+        storage.sync();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << taskCount << " bulk adds synced once: " << taskCount / seconds << " adds/s\n";
+    }
+
+    auto timeOpen = [&](const char* what) {
+        TaskSlotMap loaded;
+        TaskStorage storage;
+        auto start = chrono::steady_clock::now();
+        bool ok = storage.open(prefix, loaded);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Open " << what << ": " << loaded.size() << " tasks in " << seconds * 1e3 << " ms"
+             << (ok ? "" : " (FAILED)") << "\n";
+        return loaded;
+    };
+    tasks = timeOpen("replaying the log");
+
+    {
+        TaskStorage storage;
+        TaskSlotMap ignored;
+        if (!openOrStop(storage, ignored)) return;
+        auto start = chrono::steady_clock::now();
+        storage.compactNow(tasks);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Snapshot written in " << seconds * 1e3 << " ms\n";
+    }
+    timeOpen("from the snapshot");
+    cout << resetiosflags(ios::fixed);
+    TaskStorage::destroy(prefix);
+    removeScratchDirectory(directory);
+}
+
+// Adds tasks, then removes half of them at random, with the old vector
+// (erase shifts everything after the task) and with the slot map
+void benchmarkRemoval(size_t taskCount) {
+    mt19937_64 random(1);
+    vector<size_t> order(taskCount);
+    for (size_t i = 0; i < taskCount; i++) order[i] = i;
+    shuffle(order.begin(), order.end(), random);
+    order.resize(taskCount / 2);
+
+    auto start = chrono::steady_clock::now();
+    vector<Task> vectorTasks;
+    vector<size_t> numbers; // What each vector position was added as, to find it again
+    for (size_t i = 0; i < taskCount; i++) {
+        vectorTasks.push_back(Task("Task " + to_string(i)));
+        numbers.push_back(i);
+    }
+    for (size_t target : order) {
+        // Positions shift, so the vector has to be searched as well as shifted
+        size_t index = lower_bound(numbers.begin(), numbers.end(), target) - numbers.begin();
+        vectorTasks.erase(vectorTasks.begin() + index);
+        numbers.erase(numbers.begin() + index);
+    }
+    double vectorSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    TaskSlotMap slotTasks;
+    vector<TaskId> ids;
+    for (size_t i = 0; i < taskCount; i++) ids.push_back(slotTasks.add("Task " + to_string(i)));
+    for (size_t target : order) slotTasks.remove(ids[target]);
+    double slotSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(1) << taskCount << " adds and " << order.size() << " removals\n"
+         << "  vector erase: " << vectorSeconds * 1e3 << " ms\n"
+         << "  slot map:     " << slotSeconds * 1e3 << " ms (" << vectorSeconds / max(slotSeconds, 1e-9)
+         << "x faster)\n" << resetiosflags(ios::fixed)
+         << (vectorTasks.size() == slotTasks.size() ? "" : "SIZES DIFFER!\n");
+}
+
+// Resident memory of this process in bytes, or 0 where that is not known
+size_t residentBytes() {
+#ifdef __linux__
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long long pages = 0, resident = 0;
+    int found = fscanf(file, "%llu %llu", &pages, &resident);
+    fclose(file);
+    return found == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+// Compares one Task object per task against the slot map's arrays, arena
+// and bitsets: memory, walking every description, and counting and
+// listing completed tasks (every third task is completed)
+void benchmarkLayout(size_t taskCount) {
+    auto description = [](size_t i) { return "Task " + to_string(i) + " on the list"; };
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    double walk[2], count[2], list[2];
+    size_t memory[2], checks[2] = {0, 0};
+
+    {
+        size_t before = residentBytes();
+        TaskSlotMap tasks;
+        for (size_t i = 0; i < taskCount; i++) tasks.add(description(i), i % 3 == 0);
+        memory[1] = residentBytes() - before;
+
+        auto start = chrono::steady_clock::now();
+        size_t bytes = 0;
+        tasks.forEach([&](TaskId, string_view text, bool completed) { bytes += text.size() + completed; });
+        walk[1] = seconds(start);
+        start = chrono::steady_clock::now();
+        size_t pending = tasks.pendingCount();
+        count[1] = seconds(start);
+        start = chrono::steady_clock::now();
+        size_t completedBytes = 0;
+        tasks.forEachCompleted([&](TaskId, string_view text) { completedBytes += text.size(); });
+        list[1] = seconds(start);
+        checks[1] = bytes + pending + completedBytes;
+    }
+    {
+        size_t before = residentBytes();
+        vector<Task> tasks;
+        for (size_t i = 0; i < taskCount; i++) tasks.emplace_back(description(i), i % 3 == 0);
+        memory[0] = residentBytes() - before;
+
+        auto start = chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (const Task& task : tasks) bytes += task.getDescription().size() + task.isCompleted();
+        walk[0] = seconds(start);
+        start = chrono::steady_clock::now();
+        size_t pending = 0;
+        for (const Task& task : tasks) pending += !task.isCompleted();
+        count[0] = seconds(start);
+        start = chrono::steady_clock::now();
+        size_t completedBytes = 0;
+        for (const Task& task : tasks)
+            if (task.isCompleted()) completedBytes += task.getDescription().size();
+        list[0] = seconds(start);
+        checks[0] = bytes + pending + completedBytes;
+    }
+
+    cout << fixed << setprecision(1) << taskCount << " tasks          Task objects    slot map\n"
+         << "  bytes per task    " << setw(12) << double(memory[0]) / taskCount << setw(12)
+         << double(memory[1]) / taskCount << "\n"
+         << "  walk all (ms)     " << setw(12) << walk[0] * 1e3 << setw(12) << walk[1] * 1e3 << "\n"
+         << setprecision(3)
+         << "  count pending (ms)" << setw(12) << count[0] * 1e3 << setw(12) << count[1] * 1e3 << "\n"
+         << "  list completed(ms)" << setw(12) << list[0] * 1e3 << setw(12) << list[1] * 1e3 << "\n"
+         << resetiosflags(ios::fixed) << (checks[0] == checks[1] ? "" : "RESULTS DIFFER!\n");
+}
+
+// Builds the search index over generated tasks, then times queries with
+// it against checking every description, and times keeping it up to date
+void benchmarkSearch(size_t taskCount) {
+    mt19937_64 random(7);
+    vector<string> vocabulary;
+    for (int i = 0; i < 20000; i++) {
+        string word;
+        for (size_t length = 3 + random() % 7; word.size() < length;) word.push_back(static_cast<char>('a' + random() % 26));
+        vocabulary.push_back(word);
+    }
+    // Cubing skews the picks, so a few words are common and most are rare
+    auto pickWord = [&]() -> const string& {
+        double u = double(random() >> 11) / double(1ULL << 53);
+        return vocabulary[static_cast<size_t>(u * u * u * vocabulary.size())];
+    };
+
+    TaskSlotMap tasks;
+    vector<TaskId> ids;
+    for (size_t i = 0; i < taskCount; i++) {
+        string description = pickWord();
+        for (size_t words = 2 + random() % 5; words > 0; words--) description += " " + pickWord();
+        ids.push_back(tasks.add(description, random() % 4 == 0));
+    }
+
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto start = chrono::steady_clock::now();
+    TaskSearchIndex index;
+    index.build(tasks);
+    cout << fixed << setprecision(1) << "Indexed " << taskCount << " tasks (" << index.termCount() << " terms) in "
+         << seconds(start) * 1e3 << " ms\n";
+
+    // Answers a query by tokenizing every description
+    auto scan = [&](const string& query) {
+        vector<pair<string, bool>> words;
+        for (size_t from = 0; from < query.size();) {
+            size_t to = min(query.find(' ', from), query.size());
+            bool prefix = query[to - 1] == '*';
+            words.emplace_back(query.substr(from, to - from - prefix), prefix);
+            from = to + 1;
+        }
+        size_t matches = 0;
+        string buffer;
+        vector<string_view> terms;
+        tasks.forEach([&](TaskId, string_view description, bool) {
+            TaskSearchIndex::tokenize(description, buffer, terms);
+            for (const auto& word : words) {
+                auto found = lower_bound(terms.begin(), terms.end(), word.first);
+                if (found == terms.end() || (word.second ? found->compare(0, word.first.size(), word.first) != 0
+                                                         : *found != word.first))
+                    return;
+            }
+            matches++;
+        });
+        return matches;
+    };
+
+    const string& common = vocabulary[0];
+    const string& middling = vocabulary[vocabulary.size() / 20];
+    const string& rare = vocabulary[vocabulary.size() / 2];
+    for (const string& query : {common, rare, common + " " + middling, middling + " " + rare,
+                                common.substr(0, 2) + "*", common + " " + middling.substr(0, 3) + "*"}) {
+        start = chrono::steady_clock::now();
+        vector<uint32_t> slots = index.search(query);
+        size_t pending = 0;
+        for (uint32_t slot : slots) pending += !tasks.isCompleted(tasks.idOfSlot(slot));
+        double indexSeconds = seconds(start);
+        start = chrono::steady_clock::now();
+        size_t scanned = scan(query);
+        double scanSeconds = seconds(start);
+        cout << setprecision(3) << "  \"" << query << "\": " << slots.size() << " tasks (" << pending
+             << " pending) in " << indexSeconds * 1e3 << " ms, scanning " << scanSeconds * 1e3 << " ms"
+             << (scanned == slots.size() ? "" : " RESULTS DIFFER!") << "\n";
+    }
+
+    // Remove and re-add random tasks, as the manager does
+    const size_t changes = min<size_t>(100000, taskCount);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < changes; i++) {
+        TaskId& id = ids[random() % ids.size()];
+        string description(tasks.description(id));
+        index.remove(id.slot, description);
+        tasks.remove(id);
+        id = tasks.add(description);
+        index.add(id.slot, description);
+    }
+    cout << setprecision(2) << "  " << changes << " removes and adds: " << seconds(start) * 1e6 / changes
+         << " us each\n" << resetiosflags(ios::fixed);
+}
+
+// Records random adds, completions and removals on a large list in the
+// undo history, then times undoing, redoing and jumping through it, against
+// what copying the whole list for every step would cost
+void benchmarkHistory(size_t taskCount, size_t steps) {
+    mt19937_64 random(19);
+    TaskSlotMap tasks;
+    for (size_t i = 0; i < taskCount; i++) tasks.add("Task " + to_string(i), random() % 3 == 0);
+    auto seconds = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    auto contents = [&tasks] {
+        string text;
+        tasks.forEach([&](TaskId id, string_view, bool) { appendTaskLine(text, tasks, id); });
+        return text;
+    };
+    string first = contents();
+
+    auto start = chrono::steady_clock::now();
+    TaskSlotMap copy(tasks);
+    cout << fixed << setprecision(2) << taskCount << " tasks; a copy per step would take "
+         << seconds(start) * 1e3 << " ms and " << copy.memoryBytes() / double(1 << 20) << " MB\n";
+    copy = TaskSlotMap();
+
+    TaskHistory history;
+    size_t before = residentBytes();
+    start = chrono::steady_clock::now();
+    for (size_t step = 0; step < steps; step++) {
+        TaskId id = tasks.idOfSlot(static_cast<uint32_t>(random() % tasks.slotCount()));
+        int kind = static_cast<int>(random() % 3);
+        if (kind == 0 || !tasks.contains(id)) {
+            if (tasks.lastSlot() != TaskSlotMap::NONE) history.touch(tasks, tasks.lastSlot());
+            history.touchAdded(tasks.add("Added " + to_string(step)));
+            history.commit(tasks, "Added");
+        } else if (kind == 1 && !tasks.isCompleted(id)) {
+            history.touch(tasks, id.slot);
+            tasks.markCompleted(id);
+            history.commit(tasks, "Completed");
+        } else {
+            history.touch(tasks, id.slot);
+            if (tasks.slotBefore(id.slot) != TaskSlotMap::NONE) history.touch(tasks, tasks.slotBefore(id.slot));
+            tasks.remove(id);
+            history.commit(tasks, "Removed");
+        }
+    }
+    double recordSeconds = seconds(start);
+    size_t grown = residentBytes() - before;
+    cout << "  " << steps << " steps: " << recordSeconds * 1e6 / steps << " us and "
+         << grown / double(steps) / 1024 << " KB each\n";
+    string last = contents();
+
+    auto ignore = [](TaskHistory::Change, const TaskHistory::TaskState&, const TaskHistory::TaskState&) {};
+    const size_t moves = min<size_t>(10000, steps);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < moves; i++) history.moveTo(tasks, history.position() - 1, ignore);
+    double undoSeconds = seconds(start);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < moves; i++) history.moveTo(tasks, history.position() + 1, ignore);
+    double redoSeconds = seconds(start);
+    cout << "  undo " << undoSeconds * 1e6 / moves << " us, redo " << redoSeconds * 1e6 / moves << " us a step"
+         << (contents() == last ? "" : " LIST DIFFERS!") << "\n";
+
+    start = chrono::steady_clock::now();
+    history.moveTo(tasks, 0, ignore);
+    double backSeconds = seconds(start);
+    bool backSame = contents() == first;
+    start = chrono::steady_clock::now();
+    history.moveTo(tasks, history.size() - 1, ignore);
+    double forwardSeconds = seconds(start);
+    cout << "  jump to the start " << backSeconds * 1e3 << " ms, back to the end " << forwardSeconds * 1e3 << " ms"
+         << (backSame && contents() == last ? "" : " LIST DIFFERS!") << "\n" << resetiosflags(ios::fixed);
+}
+
+// Main function
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench-remove") == 0) {
+        benchmarkRemoval(argc > 2 ? strtoull(argv[2], nullptr, 10) : 50000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-layout") == 0) {
+        benchmarkLayout(argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-search") == 0) {
+        benchmarkSearch(argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-agenda") == 0) {
+        benchmarkAgenda(argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-import") == 0) {
+        benchmarkImport(argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-history") == 0) {
+        benchmarkHistory(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000,
+                         argc > 3 ? strtoull(argv[3], nullptr, 10) : 100000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-view") == 0) {
+        benchmarkView(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-storage") == 0) {
+        int cores = static_cast<int>(max(1u, thread::hardware_concurrency()));
+        benchmarkStorage(argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000000,
+                         argc > 3 ? atoi(argv[3]) : max(8, cores));
+        return 0;
+    }
+#ifdef __linux__
+    const string defaultSocket = "/tmp/todo-list.sock";
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        bool memory = argc > 2 && strcmp(argv[argc - 1], "--memory") == 0;
+        TaskServer server(argc > 2 + memory ? argv[2] : defaultSocket);
+        if (!server.open(memory ? "" : DATA_PREFIX)) {
+            cout << "Could not open the saved list (" << DATA_PREFIX << ".*"
+                 << (server.isBusy() ? ", another process has it open" : "") << ").\n";
+            return 1;
+        }
+        return server.run() ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--loadgen") == 0) {
+        LoadGenerator generator(argc > 2 ? argv[2] : defaultSocket,
+                                argc > 3 ? atoi(argv[3]) : max(8, static_cast<int>(thread::hardware_concurrency())),
+                                argc > 4 ? atof(argv[4]) : 10.0,
+                                argc > 5 ? atoi(argv[5]) : 10);
+        generator.run();
+        return 0;
+    }
+#endif
+    if (argc > 1 && strcmp(argv[1], "--memory") != 0) {
+        cout << "Usage:\n"
+             << "  " << argv[0] << "                                  manage the list saved in " << DATA_PREFIX << ".*\n"
+             << "  " << argv[0] << " --memory                         manage a list that is not saved\n"
+             << "  " << argv[0] << " --bench-storage [tasks] [threads] time the log and snapshots\n"
+             << "  " << argv[0] << " --bench-remove [tasks]           time removals from a large list\n"
+             << "  " << argv[0] << " --bench-layout [tasks]           compare memory and scans of task layouts\n"
+             << "  " << argv[0] << " --bench-search [tasks]           time searches over a large list\n"
+             << "  " << argv[0] << " --bench-agenda [tasks]           time agenda queries over a large list\n"
+             << "  " << argv[0] << " --bench-view [tasks]             time showing a page of a large list\n"
+             << "  " << argv[0] << " --bench-import [tasks]           time CSV and JSON lines import and export\n"
+             << "  " << argv[0] << " --bench-history [tasks] [steps]  time undo and redo on a large list\n"
+#ifdef __linux__
+             << "  " << argv[0] << " --serve [socketPath] [--memory]  serve the list over a Unix socket\n"
+             << "  " << argv[0] << " --loadgen [socketPath] [clients] [seconds] [writePercent]   load-test a server\n"
+#endif
+             ;
+        return 1;
+    }
+
     cout << "Welcome to your To-Do List Manager!\n";
-    ToDoList list;  // Create ToDoList object
+    ToDoList list(argc > 1 ? "" : DATA_PREFIX);  // Create ToDoList object
     list.run();     // Start the application
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file